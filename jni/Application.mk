@@ -1 +1,8 @@
-DIRECTORY_TO_OBJ := /home/anton/SoxPlayer/obj/local/armeabi
+# Release builds by default; build with APP_OPTIM=debug for debugging.
+# See sox/profile.mk for the per-ABI compiler settings.
+APP_ABI := armeabi-v7a arm64-v8a x86_64
+APP_PLATFORM := android-21
+APP_OPTIM ?= release
+
+# Modules link against each other's (and the prebuilt ffmpeg) libraries here
+DIRECTORY_TO_OBJ = /home/anton/SoxPlayer/obj/local/$(TARGET_ARCH_ABI)
@@ -0,0 +1,32 @@
+# Stand-in for the NDK's BUILD_SHARED_LIBRARY & BUILD_STATIC_LIBRARY: build
+# the module described by LOCAL_* as a static library.  Device-only link
+# settings (LOCAL_LDLIBS etc.) are ignored; jni/host/Makefile links sox.
+
+host_srcs := $(filter %.c %.S,$(LOCAL_SRC_FILES))
+
+ifneq ($(host_srcs),)
+ifeq ($(filter $(LOCAL_MODULE),$(HOST_SKIP_MODULES)),)
+
+host_dir := $(HOST_OUT)/$(LOCAL_MODULE)
+host_objs := $(addprefix $(host_dir)/,$(addsuffix .o,$(basename $(host_srcs))))
+host_lib := $(HOST_OUT)/$(LOCAL_MODULE).a
+
+$(host_objs): HOST_CFLAGS := -I$(LOCAL_PATH) \
+  $(addprefix -I,$(LOCAL_C_INCLUDES)) $(LOCAL_CFLAGS) -MMD -MP
+
+$(host_dir)/%.o: $(LOCAL_PATH)/%.c
+	@mkdir -p $(@D)
+	$(HOST_CC) $(HOST_CFLAGS) -c $< -o $@
+
+$(host_dir)/%.o: $(LOCAL_PATH)/%.S
+	@mkdir -p $(@D)
+	$(HOST_CC) $(HOST_CFLAGS) -c $< -o $@
+
+$(host_lib): $(host_objs)
+	rm -f $@ && $(HOST_AR) rcs $@ $^
+
+-include $(host_objs:.o=.d)
+HOST_LIBS += $(host_lib)
+
+endif
+endif
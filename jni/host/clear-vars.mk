@@ -0,0 +1,2 @@
+# Stand-in for the NDK's CLEAR_VARS: forget the previous module's settings
+$(foreach v,$(filter-out LOCAL_PATH,$(filter LOCAL_%,$(.VARIABLES))),$(eval $(v) :=))
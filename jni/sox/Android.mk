@@ -1,2 +1,3 @@
 LOCAL_PATH := $(call my-dir)
+include $(LOCAL_PATH)/profile.mk
 include $(all-subdir-makefiles)
@@ -1,6 +1,7 @@
 LOCAL_PATH := $(call my-dir)
 include $(CLEAR_VARS)
 LOCAL_ARM_MODE := arm
+LOCAL_ARM_NEON := $(SOX_ARM_NEON)
 LOCAL_STATIC_LIBRARIES := libavcore libavformat libavcodec libavutil libpostproc libswscale
 LOCAL_MODULE := ffmpeg
 include $(BUILD_SHARED_LIBRARY)
@@ -1,9 +1,21 @@
 include $(LOCAL_PATH)/../config.mak
 
+# armeabi-v7a: build the ARM & NEON code too (config.h enables it to match)
+ifeq ($(TARGET_ARCH_ABI),armeabi-v7a)
+ARCH := arm
+ARCH_ARM := yes
+HAVE_ARMV5TE := yes
+HAVE_ARMV6 := yes
+HAVE_ARMV6T2 := yes
+HAVE_ARMVFP := yes
+HAVE_NEON := yes
+endif
+
 OBJS :=
 OBJS-yes :=
 MMX-OBJS-yes :=
 include $(LOCAL_PATH)/Makefile
+-include $(LOCAL_PATH)/$(ARCH)/Makefile
 
 # collect objects
 OBJS-$(HAVE_MMX) += $(MMX-OBJS-yes)
@@ -11,7 +23,7 @@ OBJS += $(OBJS-yes)
 
 FFNAME := lib$(NAME)
 FFLIBS := $(foreach,NAME,$(FFLIBS),lib$(NAME))
-FFCFLAGS  = -DHAVE_AV_CONFIG_H -Wno-sign-compare -Wno-switch -Wno-pointer-sign
+FFCFLAGS  = $(SOX_CFLAGS) -DHAVE_AV_CONFIG_H -Wno-sign-compare -Wno-switch -Wno-pointer-sign
 FFCFLAGS += -DTARGET_CONFIG=\"config-$(TARGET_ARCH).h\"
 
 ALL_S_FILES := $(wildcard $(LOCAL_PATH)/$(TARGET_ARCH)/*.S)
@@ -10,8 +10,14 @@
 #define EXTERN_PREFIX ""
 #define EXTERN_ASM 
 #define SLIBSUF ".so"
+/* Not from configure: armeabi-v7a builds (see av.mk) use the ARM & NEON code */
+#if defined(__arm__) && defined(__ARM_NEON__)
+#define FF_ARM_NEON_BUILD 1
+#else
+#define FF_ARM_NEON_BUILD 0
+#endif
 #define ARCH_ALPHA 0
-#define ARCH_ARM 0
+#define ARCH_ARM FF_ARM_NEON_BUILD
 #define ARCH_AVR32 0
 #define ARCH_AVR32_AP 0
 #define ARCH_AVR32_UC 0
@@ -34,16 +40,16 @@
 #define HAVE_ALTIVEC 0
 #define HAVE_AMD3DNOW 0
 #define HAVE_AMD3DNOWEXT 0
-#define HAVE_ARMV5TE 0
-#define HAVE_ARMV6 0
-#define HAVE_ARMV6T2 0
-#define HAVE_ARMVFP 0
+#define HAVE_ARMV5TE FF_ARM_NEON_BUILD
+#define HAVE_ARMV6 FF_ARM_NEON_BUILD
+#define HAVE_ARMV6T2 FF_ARM_NEON_BUILD
+#define HAVE_ARMVFP FF_ARM_NEON_BUILD
 #define HAVE_AVX 0
 #define HAVE_IWMMXT 0
 #define HAVE_MMI 0
 #define HAVE_MMX 0
 #define HAVE_MMX2 0
-#define HAVE_NEON 0
+#define HAVE_NEON FF_ARM_NEON_BUILD
 #define HAVE_PPC4XX 0
 #define HAVE_SSE 0
 #define HAVE_SSSE3 0
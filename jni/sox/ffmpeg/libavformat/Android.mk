@@ -3,6 +3,7 @@ include $(CLEAR_VARS)
 include $(LOCAL_PATH)/../av.mk
 LOCAL_SRC_FILES := $(FFFILES)
 LOCAL_ARM_MODE := arm
+LOCAL_ARM_NEON := $(SOX_ARM_NEON)
 LOCAL_C_INCLUDES :=     \
     $(LOCAL_PATH)     \
     $(LOCAL_PATH)/..
@@ -4,6 +4,7 @@ include $(CLEAR_VARS)
 
 LOCAL_MODULE := libFLAC
 LOCAL_ARM_MODE := arm
+LOCAL_ARM_NEON := $(SOX_ARM_NEON)
 
 LOCAL_C_INCLUDES := $(LOCAL_PATH)/libFLAC/include/ \
 $(LOCAL_PATH)/../include/ \
@@ -35,6 +36,10 @@ LOCAL_SRC_FILES := libFLAC/bitmath.c \
 	libFLAC/float.c \
 	libFLAC/format.c \
 	libFLAC/lpc.c \
+	libFLAC/lpc_intrin_avx2.c \
+	libFLAC/lpc_intrin_neon.c \
+	libFLAC/lpc_intrin_sse2.c \
+	libFLAC/lpc_intrin_sse41.c \
 	libFLAC/md5.c \
 	libFLAC/memory.c \
 	libFLAC/metadata_iterators.c \
@@ -74,6 +79,10 @@ LOCAL_SRC_FILES := libFLAC/bitmath.c \
 	flac/utils.c \
 	flac/vorbiscomment.c \
 
+LOCAL_CFLAGS := $(SOX_CFLAGS)
+# for FLAC__stream_encoder_set_num_threads()
+LOCAL_CFLAGS += -DFLAC__HAS_PTHREAD
+
 LOCAL_SHARED_LIBRARIES := libogg libvorbis
 
 LOCAL_LDLIBS := -ldl -lGLESv1_CM -llog -L/$(DIRECTORY_TO_OBJ)
@@ -170,6 +170,8 @@ void FLAC__cpu_info(FLAC__CPUInfo *info)
 	info->data.ia32.sse2 = false;
 	info->data.ia32.sse3 = false;
 	info->data.ia32.ssse3 = false;
+	info->data.ia32.sse41 = false;
+	info->data.ia32.avx2 = false;
 	info->data.ia32._3dnow = false;
 	info->data.ia32.ext3dnow = false;
 	info->data.ia32.extmmx = false;
@@ -408,6 +410,38 @@ void FLAC__cpu_info(FLAC__CPUInfo *info)
 	info->use_asm = false;
 # endif
 
+/*
+ * x86 & x86-64 built without NASM, for the intrinsic routines
+ */
+#elif defined FLAC__HAS_X86INTRIN
+# ifdef __x86_64__
+	info->type = FLAC__CPUINFO_TYPE_X86_64;
+# else
+	info->type = FLAC__CPUINFO_TYPE_IA32;
+# endif
+	info->use_asm = true;
+	__builtin_cpu_init();
+	info->data.ia32.cpuid = true;
+	info->data.ia32.bswap = true;
+	info->data.ia32.cmov = __builtin_cpu_supports("cmov")? true : false;
+	info->data.ia32.mmx = __builtin_cpu_supports("mmx")? true : false;
+	info->data.ia32.fxsr = false;
+	info->data.ia32.sse = __builtin_cpu_supports("sse")? true : false;
+	info->data.ia32.sse2 = __builtin_cpu_supports("sse2")? true : false;
+	info->data.ia32.sse3 = __builtin_cpu_supports("sse3")? true : false;
+	info->data.ia32.ssse3 = __builtin_cpu_supports("ssse3")? true : false;
+	info->data.ia32.sse41 = __builtin_cpu_supports("sse4.1")? true : false;
+	info->data.ia32.avx2 = __builtin_cpu_supports("avx2")? true : false;
+	info->data.ia32._3dnow = info->data.ia32.ext3dnow = info->data.ia32.extmmx = false;
+
+/*
+ * ARM with NEON
+ */
+#elif defined FLAC__HAS_NEONINTRIN
+	info->type = FLAC__CPUINFO_TYPE_ARM;
+	info->use_asm = true;
+	info->data.arm.neon = true; /* the compiler targets it, so it must be there */
+
 /*
  * unknown CPI
  */
@@ -38,9 +38,32 @@
 #include <config.h>
 #endif
 
+/*
+ * Without NASM (as in the NDK build), x86 & x86-64 get routines written
+ * with compiler intrinsics, each compiled for its instruction set by a
+ * function attribute and selected at run time from the CPU info.  ARM gets
+ * NEON routines where the compiler targets NEON, but only if
+ * FLAC__USE_NEONINTRIN is defined (as by SOX_NEON_KERNELS in profile.mk):
+ * they are yet to be built and tested on ARM, so by default ARM keeps the C
+ * routines.
+ */
+#if !defined FLAC__NO_ASM && !defined FLAC__CPU_IA32 && (defined __x86_64__ || defined __i386__) && \
+	(defined __clang__ || __GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+#define FLAC__HAS_X86INTRIN 1
+#define FLAC__SSE2_TARGET __attribute__((target("sse2")))
+#define FLAC__SSE41_TARGET __attribute__((target("sse4.1")))
+#define FLAC__AVX2_TARGET __attribute__((target("avx2")))
+#endif
+
+#if !defined FLAC__NO_ASM && defined FLAC__USE_NEONINTRIN && (defined __ARM_NEON__ || defined __ARM_NEON)
+#define FLAC__HAS_NEONINTRIN 1
+#endif
+
 typedef enum {
 	FLAC__CPUINFO_TYPE_IA32,
+	FLAC__CPUINFO_TYPE_X86_64,
 	FLAC__CPUINFO_TYPE_PPC,
+	FLAC__CPUINFO_TYPE_ARM,
 	FLAC__CPUINFO_TYPE_UNKNOWN
 } FLAC__CPUInfo_Type;
 
@@ -54,6 +77,8 @@ typedef struct {
 	FLAC__bool sse2;
 	FLAC__bool sse3;
 	FLAC__bool ssse3;
+	FLAC__bool sse41;
+	FLAC__bool avx2;
 	FLAC__bool _3dnow;
 	FLAC__bool ext3dnow;
 	FLAC__bool extmmx;
@@ -64,12 +89,17 @@ typedef struct {
 	FLAC__bool ppc64;
 } FLAC__CPUInfo_PPC;
 
+typedef struct {
+	FLAC__bool neon;
+} FLAC__CPUInfo_ARM;
+
 typedef struct {
 	FLAC__bool use_asm;
 	FLAC__CPUInfo_Type type;
 	union {
-		FLAC__CPUInfo_IA32 ia32;
+		FLAC__CPUInfo_IA32 ia32; /* also for FLAC__CPUINFO_TYPE_X86_64 */
 		FLAC__CPUInfo_PPC ppc;
+		FLAC__CPUInfo_ARM arm;
 	} data;
 } FLAC__CPUInfo;
 
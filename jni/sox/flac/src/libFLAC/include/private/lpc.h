@@ -36,6 +36,7 @@
 #include <config.h>
 #endif
 
+#include "private/cpu.h"
 #include "private/float.h"
 #include "FLAC/format.h"
 
@@ -53,6 +54,12 @@
  *	IN data_len
  */
 void FLAC__lpc_window_data(const FLAC__int32 in[], const FLAC__real window[], FLAC__real out[], unsigned data_len);
+#ifdef FLAC__HAS_X86INTRIN
+void FLAC__lpc_window_data_intrin_sse2(const FLAC__int32 in[], const FLAC__real window[], FLAC__real out[], unsigned data_len);
+void FLAC__lpc_window_data_intrin_avx2(const FLAC__int32 in[], const FLAC__real window[], FLAC__real out[], unsigned data_len);
+#elif defined FLAC__HAS_NEONINTRIN
+void FLAC__lpc_window_data_intrin_neon(const FLAC__int32 in[], const FLAC__real window[], FLAC__real out[], unsigned data_len);
+#endif
 
 /*
  *	FLAC__lpc_compute_autocorrelation()
@@ -78,6 +85,12 @@ void FLAC__lpc_compute_autocorrelation_asm_ia32_3dnow(const FLAC__real data[], u
 #    endif
 #  endif
 #endif
+#ifdef FLAC__HAS_X86INTRIN
+void FLAC__lpc_compute_autocorrelation_intrin_sse2(const FLAC__real data[], unsigned data_len, unsigned lag, FLAC__real autoc[]);
+void FLAC__lpc_compute_autocorrelation_intrin_avx2(const FLAC__real data[], unsigned data_len, unsigned lag, FLAC__real autoc[]);
+#elif defined FLAC__HAS_NEONINTRIN
+void FLAC__lpc_compute_autocorrelation_intrin_neon(const FLAC__real data[], unsigned data_len, unsigned lag, FLAC__real autoc[]);
+#endif
 
 /*
  *	FLAC__lpc_compute_lp_coefficients()
@@ -147,6 +160,12 @@ void FLAC__lpc_compute_residual_from_qlp_coefficients_asm_ia32_mmx(const FLAC__i
 #    endif
 #  endif
 #endif
+#ifdef FLAC__HAS_X86INTRIN
+void FLAC__lpc_compute_residual_from_qlp_coefficients_intrin_sse41(const FLAC__int32 *data, unsigned data_len, const FLAC__int32 qlp_coeff[], unsigned order, int lp_quantization, FLAC__int32 residual[]);
+void FLAC__lpc_compute_residual_from_qlp_coefficients_intrin_avx2(const FLAC__int32 *data, unsigned data_len, const FLAC__int32 qlp_coeff[], unsigned order, int lp_quantization, FLAC__int32 residual[]);
+#elif defined FLAC__HAS_NEONINTRIN
+void FLAC__lpc_compute_residual_from_qlp_coefficients_intrin_neon(const FLAC__int32 *data, unsigned data_len, const FLAC__int32 qlp_coeff[], unsigned order, int lp_quantization, FLAC__int32 residual[]);
+#endif
 
 #endif /* !defined FLAC__INTEGER_ONLY_LIBRARY */
 
@@ -178,6 +197,11 @@ void FLAC__lpc_restore_signal_asm_ppc_altivec_16(const FLAC__int32 residual[], u
 void FLAC__lpc_restore_signal_asm_ppc_altivec_16_order8(const FLAC__int32 residual[], unsigned data_len, const FLAC__int32 qlp_coeff[], unsigned order, int lp_quantization, FLAC__int32 data[]);
 #  endif/* FLAC__CPU_IA32 || FLAC__CPU_PPC */
 #endif /* FLAC__NO_ASM */
+#ifdef FLAC__HAS_X86INTRIN
+void FLAC__lpc_restore_signal_intrin_sse41(const FLAC__int32 residual[], unsigned data_len, const FLAC__int32 qlp_coeff[], unsigned order, int lp_quantization, FLAC__int32 data[]);
+#elif defined FLAC__HAS_NEONINTRIN
+void FLAC__lpc_restore_signal_intrin_neon(const FLAC__int32 residual[], unsigned data_len, const FLAC__int32 qlp_coeff[], unsigned order, int lp_quantization, FLAC__int32 data[]);
+#endif
 
 #ifndef FLAC__INTEGER_ONLY_LIBRARY
 
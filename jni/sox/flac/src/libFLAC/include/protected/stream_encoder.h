@@ -99,6 +99,7 @@ typedef struct FLAC__StreamEncoderProtected {
 	unsigned max_residual_partition_order;
 	unsigned rice_parameter_search_dist;
 	FLAC__uint64 total_samples_estimate;
+	unsigned num_threads;
 	FLAC__StreamMetadata **metadata;
 	unsigned num_metadata_blocks;
 	FLAC__uint64 streaminfo_offset, seektable_offset, audio_offset;
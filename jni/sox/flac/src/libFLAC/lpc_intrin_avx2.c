@@ -0,0 +1,150 @@
+/* libFLAC - Free Lossless Audio Codec library
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the Xiph.org Foundation nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE FOUNDATION OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#if HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include "private/cpu.h"
+
+#ifndef FLAC__INTEGER_ONLY_LIBRARY
+#ifdef FLAC__HAS_X86INTRIN
+
+#include <immintrin.h>
+#include <string.h> /* for memcpy() */
+#include "FLAC/assert.h"
+#include "private/lpc.h"
+
+#ifdef min
+#undef min
+#endif
+#define min(x,y) ((x)<(y)?(x):(y))
+
+FLAC__AVX2_TARGET
+void FLAC__lpc_window_data_intrin_avx2(const FLAC__int32 in[], const FLAC__real window[], FLAC__real out[], unsigned data_len)
+{
+	unsigned i;
+
+	for(i = 0; i + 8 <= data_len; i += 8)
+		_mm256_storeu_ps(out+i, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_loadu_si256((const __m256i*)(in+i))), _mm256_loadu_ps(window+i)));
+	for(; i < data_len; i++)
+		out[i] = in[i] * window[i];
+}
+
+/* as FLAC__lpc_compute_autocorrelation_intrin_sse2(), 8 lags to a vector */
+FLAC__AVX2_TARGET
+void FLAC__lpc_compute_autocorrelation_intrin_avx2(const FLAC__real data[], unsigned data_len, unsigned lag, FLAC__real autoc[])
+{
+	FLAC__real sum[16];
+	unsigned base, sample, coeff, n;
+
+	FLAC__ASSERT(lag > 0);
+	FLAC__ASSERT(lag <= data_len);
+
+	for(base = 0; base < lag; base += 16) {
+		const FLAC__real *x = data + base;
+		__m256 s0 = _mm256_setzero_ps(), s1 = s0;
+
+		n = min(lag - base, 16);
+		for(sample = 0; sample + base + 16 <= data_len; sample++) {
+			const __m256 d = _mm256_set1_ps(data[sample]);
+			/* not fused, to round as the C version does */
+			s0 = _mm256_add_ps(s0, _mm256_mul_ps(d, _mm256_loadu_ps(x+sample)));
+			s1 = _mm256_add_ps(s1, _mm256_mul_ps(d, _mm256_loadu_ps(x+sample+8)));
+		}
+		_mm256_storeu_ps(sum, s0);
+		_mm256_storeu_ps(sum+8, s1);
+		for(; sample < data_len; sample++) {
+			const FLAC__real d = data[sample];
+			for(coeff = 0; coeff < n && sample + base + coeff < data_len; coeff++)
+				sum[coeff] += d * x[sample+coeff];
+		}
+		memcpy(autoc+base, sum, sizeof(FLAC__real) * n);
+	}
+}
+
+/* as in lpc_intrin_sse41.c, inlined with a constant order up to 12 */
+FLAC__AVX2_TARGET static __inline__ __attribute__((always_inline))
+void compute_residual_(const FLAC__int32 *data, unsigned data_len, const FLAC__int32 qlp_coeff[], unsigned order, int lp_quantization, FLAC__int32 residual[])
+{
+	__m256i q[32];
+	const __m128i cnt = _mm_cvtsi32_si128(lp_quantization);
+	unsigned i, j;
+	FLAC__int32 sum;
+	const FLAC__int32 *history;
+
+	for(j = 0; j < order; j++)
+		q[j] = _mm256_set1_epi32(qlp_coeff[j]);
+
+	for(i = 0; i + 16 <= data_len; i += 16) {
+		__m256i s0 = _mm256_mullo_epi32(q[0], _mm256_loadu_si256((const __m256i*)(data+i-1)));
+		__m256i s1 = _mm256_mullo_epi32(q[0], _mm256_loadu_si256((const __m256i*)(data+i+7)));
+		for(j = 1; j < order; j++) {
+			s0 = _mm256_add_epi32(s0, _mm256_mullo_epi32(q[j], _mm256_loadu_si256((const __m256i*)(data+i-j-1))));
+			s1 = _mm256_add_epi32(s1, _mm256_mullo_epi32(q[j], _mm256_loadu_si256((const __m256i*)(data+i-j+7))));
+		}
+		_mm256_storeu_si256((__m256i*)(residual+i), _mm256_sub_epi32(_mm256_loadu_si256((const __m256i*)(data+i)), _mm256_sra_epi32(s0, cnt)));
+		_mm256_storeu_si256((__m256i*)(residual+i+8), _mm256_sub_epi32(_mm256_loadu_si256((const __m256i*)(data+i+8)), _mm256_sra_epi32(s1, cnt)));
+	}
+	for(; i < data_len; i++) {
+		sum = 0;
+		history = data + i;
+		for(j = 0; j < order; j++)
+			sum += qlp_coeff[j] * (*(--history));
+		residual[i] = data[i] - (sum >> lp_quantization);
+	}
+}
+
+FLAC__AVX2_TARGET
+void FLAC__lpc_compute_residual_from_qlp_coefficients_intrin_avx2(const FLAC__int32 *data, unsigned data_len, const FLAC__int32 qlp_coeff[], unsigned order, int lp_quantization, FLAC__int32 residual[])
+{
+	FLAC__ASSERT(order > 0);
+	FLAC__ASSERT(order <= 32);
+	FLAC__ASSERT(lp_quantization >= 0);
+
+	switch(order) {
+		case 1: compute_residual_(data, data_len, qlp_coeff, 1, lp_quantization, residual); break;
+		case 2: compute_residual_(data, data_len, qlp_coeff, 2, lp_quantization, residual); break;
+		case 3: compute_residual_(data, data_len, qlp_coeff, 3, lp_quantization, residual); break;
+		case 4: compute_residual_(data, data_len, qlp_coeff, 4, lp_quantization, residual); break;
+		case 5: compute_residual_(data, data_len, qlp_coeff, 5, lp_quantization, residual); break;
+		case 6: compute_residual_(data, data_len, qlp_coeff, 6, lp_quantization, residual); break;
+		case 7: compute_residual_(data, data_len, qlp_coeff, 7, lp_quantization, residual); break;
+		case 8: compute_residual_(data, data_len, qlp_coeff, 8, lp_quantization, residual); break;
+		case 9: compute_residual_(data, data_len, qlp_coeff, 9, lp_quantization, residual); break;
+		case 10: compute_residual_(data, data_len, qlp_coeff, 10, lp_quantization, residual); break;
+		case 11: compute_residual_(data, data_len, qlp_coeff, 11, lp_quantization, residual); break;
+		case 12: compute_residual_(data, data_len, qlp_coeff, 12, lp_quantization, residual); break;
+		default: compute_residual_(data, data_len, qlp_coeff, order, lp_quantization, residual); break;
+	}
+}
+
+#endif /* FLAC__HAS_X86INTRIN */
+#endif /* !FLAC__INTEGER_ONLY_LIBRARY */
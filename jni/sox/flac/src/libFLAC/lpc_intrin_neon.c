@@ -0,0 +1,206 @@
+/* libFLAC - Free Lossless Audio Codec library
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the Xiph.org Foundation nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE FOUNDATION OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#if HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include "private/cpu.h"
+
+#ifdef FLAC__HAS_NEONINTRIN
+
+#include <arm_neon.h>
+#include <string.h> /* for memcpy() */
+#include "FLAC/assert.h"
+#include "private/lpc.h"
+
+#ifndef FLAC__INTEGER_ONLY_LIBRARY
+
+#ifdef min
+#undef min
+#endif
+#define min(x,y) ((x)<(y)?(x):(y))
+
+void FLAC__lpc_window_data_intrin_neon(const FLAC__int32 in[], const FLAC__real window[], FLAC__real out[], unsigned data_len)
+{
+	unsigned i;
+
+	for(i = 0; i + 4 <= data_len; i += 4)
+		vst1q_f32(out+i, vmulq_f32(vcvtq_f32_s32(vld1q_s32(in+i)), vld1q_f32(window+i)));
+	for(; i < data_len; i++)
+		out[i] = in[i] * window[i];
+}
+
+/* as FLAC__lpc_compute_autocorrelation_intrin_sse2() */
+void FLAC__lpc_compute_autocorrelation_intrin_neon(const FLAC__real data[], unsigned data_len, unsigned lag, FLAC__real autoc[])
+{
+	FLAC__real sum[16];
+	unsigned base, sample, coeff, n;
+
+	FLAC__ASSERT(lag > 0);
+	FLAC__ASSERT(lag <= data_len);
+
+	for(base = 0; base < lag; base += 16) {
+		const FLAC__real *x = data + base;
+		float32x4_t s0 = vdupq_n_f32(0.0f), s1 = s0, s2 = s0, s3 = s0;
+
+		n = min(lag - base, 16);
+		for(sample = 0; sample + base + 16 <= data_len; sample++) {
+			const float32x4_t d = vdupq_n_f32(data[sample]);
+			s0 = vaddq_f32(s0, vmulq_f32(d, vld1q_f32(x+sample)));
+			s1 = vaddq_f32(s1, vmulq_f32(d, vld1q_f32(x+sample+4)));
+			s2 = vaddq_f32(s2, vmulq_f32(d, vld1q_f32(x+sample+8)));
+			s3 = vaddq_f32(s3, vmulq_f32(d, vld1q_f32(x+sample+12)));
+		}
+		vst1q_f32(sum, s0);
+		vst1q_f32(sum+4, s1);
+		vst1q_f32(sum+8, s2);
+		vst1q_f32(sum+12, s3);
+		for(; sample < data_len; sample++) {
+			const FLAC__real d = data[sample];
+			for(coeff = 0; coeff < n && sample + base + coeff < data_len; coeff++)
+				sum[coeff] += d * x[sample+coeff];
+		}
+		memcpy(autoc+base, sum, sizeof(FLAC__real) * n);
+	}
+}
+
+/* as in lpc_intrin_sse41.c, inlined with a constant order up to 12 */
+static __inline__ __attribute__((always_inline))
+void compute_residual_(const FLAC__int32 *data, unsigned data_len, const FLAC__int32 qlp_coeff[], unsigned order, int lp_quantization, FLAC__int32 residual[])
+{
+	/* shifting left by a negative count is an arithmetic shift right */
+	const int32x4_t cnt = vdupq_n_s32(-lp_quantization);
+	unsigned i, j;
+	FLAC__int32 sum;
+	const FLAC__int32 *history;
+
+	for(i = 0; i + 8 <= data_len; i += 8) {
+		int32x4_t s0 = vmulq_n_s32(vld1q_s32(data+i-1), qlp_coeff[0]);
+		int32x4_t s1 = vmulq_n_s32(vld1q_s32(data+i+3), qlp_coeff[0]);
+		for(j = 1; j < order; j++) {
+			s0 = vmlaq_n_s32(s0, vld1q_s32(data+i-j-1), qlp_coeff[j]);
+			s1 = vmlaq_n_s32(s1, vld1q_s32(data+i-j+3), qlp_coeff[j]);
+		}
+		vst1q_s32(residual+i, vsubq_s32(vld1q_s32(data+i), vshlq_s32(s0, cnt)));
+		vst1q_s32(residual+i+4, vsubq_s32(vld1q_s32(data+i+4), vshlq_s32(s1, cnt)));
+	}
+	for(; i < data_len; i++) {
+		sum = 0;
+		history = data + i;
+		for(j = 0; j < order; j++)
+			sum += qlp_coeff[j] * (*(--history));
+		residual[i] = data[i] - (sum >> lp_quantization);
+	}
+}
+
+void FLAC__lpc_compute_residual_from_qlp_coefficients_intrin_neon(const FLAC__int32 *data, unsigned data_len, const FLAC__int32 qlp_coeff[], unsigned order, int lp_quantization, FLAC__int32 residual[])
+{
+	FLAC__ASSERT(order > 0);
+	FLAC__ASSERT(order <= 32);
+	FLAC__ASSERT(lp_quantization >= 0);
+
+	switch(order) {
+		case 1: compute_residual_(data, data_len, qlp_coeff, 1, lp_quantization, residual); break;
+		case 2: compute_residual_(data, data_len, qlp_coeff, 2, lp_quantization, residual); break;
+		case 3: compute_residual_(data, data_len, qlp_coeff, 3, lp_quantization, residual); break;
+		case 4: compute_residual_(data, data_len, qlp_coeff, 4, lp_quantization, residual); break;
+		case 5: compute_residual_(data, data_len, qlp_coeff, 5, lp_quantization, residual); break;
+		case 6: compute_residual_(data, data_len, qlp_coeff, 6, lp_quantization, residual); break;
+		case 7: compute_residual_(data, data_len, qlp_coeff, 7, lp_quantization, residual); break;
+		case 8: compute_residual_(data, data_len, qlp_coeff, 8, lp_quantization, residual); break;
+		case 9: compute_residual_(data, data_len, qlp_coeff, 9, lp_quantization, residual); break;
+		case 10: compute_residual_(data, data_len, qlp_coeff, 10, lp_quantization, residual); break;
+		case 11: compute_residual_(data, data_len, qlp_coeff, 11, lp_quantization, residual); break;
+		case 12: compute_residual_(data, data_len, qlp_coeff, 12, lp_quantization, residual); break;
+		default: compute_residual_(data, data_len, qlp_coeff, order, lp_quantization, residual); break;
+	}
+}
+
+#endif /* !FLAC__INTEGER_ONLY_LIBRARY */
+
+/*
+ * As in lpc_intrin_sse41.c, coefficients 7 and up go in the vectors and
+ * the rest are done with scalars; the order below which the C version is
+ * used is the one found for SSE4.1.
+ */
+#define SCALAR_ORDER_ 7
+
+static __inline__ __attribute__((always_inline))
+void restore_signal_(const FLAC__int32 residual[], unsigned data_len, const FLAC__int32 qlp_coeff[], unsigned order, int lp_quantization, FLAC__int32 data[])
+{
+	int32x4_t s;
+	const FLAC__int32 q0 = qlp_coeff[0], q1 = qlp_coeff[1], q2 = qlp_coeff[2], q3 = qlp_coeff[3], q4 = qlp_coeff[4], q5 = qlp_coeff[5], q6 = qlp_coeff[6];
+	FLAC__int32 d[4], m1, m2, m3, m4, m5, m6, m7;
+	unsigned i, j;
+	FLAC__int32 sum;
+	const FLAC__int32 *history;
+
+	for(i = 0; i + 4 <= data_len; i += 4) {
+		s = vmulq_n_s32(vld1q_s32(data+i-SCALAR_ORDER_-1), qlp_coeff[SCALAR_ORDER_]);
+		for(j = SCALAR_ORDER_+1; j < order; j++)
+			s = vmlaq_n_s32(s, vld1q_s32(data+i-j-1), qlp_coeff[j]);
+		history = data + i;
+		m1 = history[-1]; m2 = history[-2]; m3 = history[-3]; m4 = history[-4]; m5 = history[-5]; m6 = history[-6]; m7 = history[-7];
+		d[0] = residual[i] + ((vgetq_lane_s32(s, 0) + q6*m7 + q5*m6 + q4*m5 + q3*m4 + q2*m3 + q1*m2 + q0*m1) >> lp_quantization);
+		d[1] = residual[i+1] + ((vgetq_lane_s32(s, 1) + q6*m6 + q5*m5 + q4*m4 + q3*m3 + q2*m2 + q1*m1 + q0*d[0]) >> lp_quantization);
+		d[2] = residual[i+2] + ((vgetq_lane_s32(s, 2) + q6*m5 + q5*m4 + q4*m3 + q3*m2 + q2*m1 + q1*d[0] + q0*d[1]) >> lp_quantization);
+		d[3] = residual[i+3] + ((vgetq_lane_s32(s, 3) + q6*m4 + q5*m3 + q4*m2 + q3*m1 + q2*d[0] + q1*d[1] + q0*d[2]) >> lp_quantization);
+		vst1q_s32(data+i, vld1q_s32(d));
+	}
+	for(; i < data_len; i++) {
+		sum = 0;
+		history = data + i;
+		for(j = 0; j < order; j++)
+			sum += qlp_coeff[j] * (*(--history));
+		data[i] = residual[i] + (sum >> lp_quantization);
+	}
+}
+
+void FLAC__lpc_restore_signal_intrin_neon(const FLAC__int32 residual[], unsigned data_len, const FLAC__int32 qlp_coeff[], unsigned order, int lp_quantization, FLAC__int32 data[])
+{
+	FLAC__ASSERT(order > 0);
+	FLAC__ASSERT(order <= 32);
+
+	/* the C version also copes with a negative shift, which is not valid FLAC */
+	if(order < 10 || lp_quantization < 0) {
+		FLAC__lpc_restore_signal(residual, data_len, qlp_coeff, order, lp_quantization, data);
+		return;
+	}
+
+	switch(order) {
+		case 10: restore_signal_(residual, data_len, qlp_coeff, 10, lp_quantization, data); break;
+		case 11: restore_signal_(residual, data_len, qlp_coeff, 11, lp_quantization, data); break;
+		case 12: restore_signal_(residual, data_len, qlp_coeff, 12, lp_quantization, data); break;
+		default: restore_signal_(residual, data_len, qlp_coeff, order, lp_quantization, data); break;
+	}
+}
+
+#endif /* FLAC__HAS_NEONINTRIN */
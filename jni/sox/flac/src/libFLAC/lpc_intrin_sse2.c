@@ -0,0 +1,103 @@
+/* libFLAC - Free Lossless Audio Codec library
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the Xiph.org Foundation nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE FOUNDATION OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#if HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include "private/cpu.h"
+
+#ifndef FLAC__INTEGER_ONLY_LIBRARY
+#ifdef FLAC__HAS_X86INTRIN
+
+#include <emmintrin.h>
+#include <string.h> /* for memcpy() */
+#include "FLAC/assert.h"
+#include "private/lpc.h"
+
+#ifdef min
+#undef min
+#endif
+#define min(x,y) ((x)<(y)?(x):(y))
+
+FLAC__SSE2_TARGET
+void FLAC__lpc_window_data_intrin_sse2(const FLAC__int32 in[], const FLAC__real window[], FLAC__real out[], unsigned data_len)
+{
+	unsigned i;
+
+	for(i = 0; i + 4 <= data_len; i += 4)
+		_mm_storeu_ps(out+i, _mm_mul_ps(_mm_cvtepi32_ps(_mm_loadu_si128((const __m128i*)(in+i))), _mm_loadu_ps(window+i)));
+	for(; i < data_len; i++)
+		out[i] = in[i] * window[i];
+}
+
+/*
+ * Each lag is summed over the samples in the same order as in
+ * FLAC__lpc_compute_autocorrelation(), so the result is the same; the
+ * vectors hold 16 consecutive lags, for as many passes over the data as
+ * it takes to cover 'lag' of them.
+ */
+FLAC__SSE2_TARGET
+void FLAC__lpc_compute_autocorrelation_intrin_sse2(const FLAC__real data[], unsigned data_len, unsigned lag, FLAC__real autoc[])
+{
+	FLAC__real sum[16];
+	unsigned base, sample, coeff, n;
+
+	FLAC__ASSERT(lag > 0);
+	FLAC__ASSERT(lag <= data_len);
+
+	for(base = 0; base < lag; base += 16) {
+		const FLAC__real *x = data + base;
+		__m128 s0 = _mm_setzero_ps(), s1 = s0, s2 = s0, s3 = s0;
+
+		n = min(lag - base, 16);
+		/* while all 16 lags are within data[] */
+		for(sample = 0; sample + base + 16 <= data_len; sample++) {
+			const __m128 d = _mm_set1_ps(data[sample]);
+			s0 = _mm_add_ps(s0, _mm_mul_ps(d, _mm_loadu_ps(x+sample)));
+			s1 = _mm_add_ps(s1, _mm_mul_ps(d, _mm_loadu_ps(x+sample+4)));
+			s2 = _mm_add_ps(s2, _mm_mul_ps(d, _mm_loadu_ps(x+sample+8)));
+			s3 = _mm_add_ps(s3, _mm_mul_ps(d, _mm_loadu_ps(x+sample+12)));
+		}
+		_mm_storeu_ps(sum, s0);
+		_mm_storeu_ps(sum+4, s1);
+		_mm_storeu_ps(sum+8, s2);
+		_mm_storeu_ps(sum+12, s3);
+		for(; sample < data_len; sample++) {
+			const FLAC__real d = data[sample];
+			for(coeff = 0; coeff < n && sample + base + coeff < data_len; coeff++)
+				sum[coeff] += d * x[sample+coeff];
+		}
+		memcpy(autoc+base, sum, sizeof(FLAC__real) * n);
+	}
+}
+
+#endif /* FLAC__HAS_X86INTRIN */
+#endif /* !FLAC__INTEGER_ONLY_LIBRARY */
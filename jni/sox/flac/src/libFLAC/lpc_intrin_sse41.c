@@ -0,0 +1,172 @@
+/* libFLAC - Free Lossless Audio Codec library
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the Xiph.org Foundation nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE FOUNDATION OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#if HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include "private/cpu.h"
+
+#ifdef FLAC__HAS_X86INTRIN
+
+#include <smmintrin.h>
+#include "FLAC/assert.h"
+#include "private/lpc.h"
+
+#ifndef FLAC__INTEGER_ONLY_LIBRARY
+
+/*
+ * Inlined with a constant order for the orders up to 12 (the subset
+ * limit), so that the loop over the coefficients is unrolled and they stay
+ * in registers, as in the unrolled C version.
+ */
+FLAC__SSE41_TARGET static __inline__ __attribute__((always_inline))
+void compute_residual_(const FLAC__int32 *data, unsigned data_len, const FLAC__int32 qlp_coeff[], unsigned order, int lp_quantization, FLAC__int32 residual[])
+{
+	__m128i q[32];
+	const __m128i cnt = _mm_cvtsi32_si128(lp_quantization);
+	unsigned i, j;
+	FLAC__int32 sum;
+	const FLAC__int32 *history;
+
+	for(j = 0; j < order; j++)
+		q[j] = _mm_set1_epi32(qlp_coeff[j]);
+
+	for(i = 0; i + 8 <= data_len; i += 8) {
+		__m128i s0 = _mm_mullo_epi32(q[0], _mm_loadu_si128((const __m128i*)(data+i-1)));
+		__m128i s1 = _mm_mullo_epi32(q[0], _mm_loadu_si128((const __m128i*)(data+i+3)));
+		for(j = 1; j < order; j++) {
+			s0 = _mm_add_epi32(s0, _mm_mullo_epi32(q[j], _mm_loadu_si128((const __m128i*)(data+i-j-1))));
+			s1 = _mm_add_epi32(s1, _mm_mullo_epi32(q[j], _mm_loadu_si128((const __m128i*)(data+i-j+3))));
+		}
+		_mm_storeu_si128((__m128i*)(residual+i), _mm_sub_epi32(_mm_loadu_si128((const __m128i*)(data+i)), _mm_sra_epi32(s0, cnt)));
+		_mm_storeu_si128((__m128i*)(residual+i+4), _mm_sub_epi32(_mm_loadu_si128((const __m128i*)(data+i+4)), _mm_sra_epi32(s1, cnt)));
+	}
+	for(; i < data_len; i++) {
+		sum = 0;
+		history = data + i;
+		for(j = 0; j < order; j++)
+			sum += qlp_coeff[j] * (*(--history));
+		residual[i] = data[i] - (sum >> lp_quantization);
+	}
+}
+
+FLAC__SSE41_TARGET
+void FLAC__lpc_compute_residual_from_qlp_coefficients_intrin_sse41(const FLAC__int32 *data, unsigned data_len, const FLAC__int32 qlp_coeff[], unsigned order, int lp_quantization, FLAC__int32 residual[])
+{
+	FLAC__ASSERT(order > 0);
+	FLAC__ASSERT(order <= 32);
+	FLAC__ASSERT(lp_quantization >= 0);
+
+	switch(order) {
+		case 1: compute_residual_(data, data_len, qlp_coeff, 1, lp_quantization, residual); break;
+		case 2: compute_residual_(data, data_len, qlp_coeff, 2, lp_quantization, residual); break;
+		case 3: compute_residual_(data, data_len, qlp_coeff, 3, lp_quantization, residual); break;
+		case 4: compute_residual_(data, data_len, qlp_coeff, 4, lp_quantization, residual); break;
+		case 5: compute_residual_(data, data_len, qlp_coeff, 5, lp_quantization, residual); break;
+		case 6: compute_residual_(data, data_len, qlp_coeff, 6, lp_quantization, residual); break;
+		case 7: compute_residual_(data, data_len, qlp_coeff, 7, lp_quantization, residual); break;
+		case 8: compute_residual_(data, data_len, qlp_coeff, 8, lp_quantization, residual); break;
+		case 9: compute_residual_(data, data_len, qlp_coeff, 9, lp_quantization, residual); break;
+		case 10: compute_residual_(data, data_len, qlp_coeff, 10, lp_quantization, residual); break;
+		case 11: compute_residual_(data, data_len, qlp_coeff, 11, lp_quantization, residual); break;
+		case 12: compute_residual_(data, data_len, qlp_coeff, 12, lp_quantization, residual); break;
+		default: compute_residual_(data, data_len, qlp_coeff, order, lp_quantization, residual); break;
+	}
+}
+
+#endif /* !FLAC__INTEGER_ONLY_LIBRARY */
+
+/*
+ * Each sample depends on the one just restored, so only the part of the
+ * prediction from samples old enough not to be on that dependency chain
+ * (coefficients 7 and up, for four samples at a time) goes in the vectors;
+ * the rest is done with scalars, as in the C version.  Below order 10
+ * that leaves too little for the vectors to pay for themselves, so the C
+ * version is used there.
+ */
+#define SCALAR_ORDER_ 7
+
+FLAC__SSE41_TARGET static __inline__ __attribute__((always_inline))
+void restore_signal_(const FLAC__int32 residual[], unsigned data_len, const FLAC__int32 qlp_coeff[], unsigned order, int lp_quantization, FLAC__int32 data[])
+{
+	__m128i q[32], s;
+	const FLAC__int32 q0 = qlp_coeff[0], q1 = qlp_coeff[1], q2 = qlp_coeff[2], q3 = qlp_coeff[3], q4 = qlp_coeff[4], q5 = qlp_coeff[5], q6 = qlp_coeff[6];
+	FLAC__int32 d0, d1, d2, d3, m1, m2, m3, m4, m5, m6, m7;
+	unsigned i, j;
+	FLAC__int32 sum;
+	const FLAC__int32 *history;
+
+	for(j = SCALAR_ORDER_; j < order; j++)
+		q[j] = _mm_set1_epi32(qlp_coeff[j]);
+
+	for(i = 0; i + 4 <= data_len; i += 4) {
+		s = _mm_mullo_epi32(q[SCALAR_ORDER_], _mm_loadu_si128((const __m128i*)(data+i-SCALAR_ORDER_-1)));
+		for(j = SCALAR_ORDER_+1; j < order; j++)
+			s = _mm_add_epi32(s, _mm_mullo_epi32(q[j], _mm_loadu_si128((const __m128i*)(data+i-j-1))));
+		/* the four new samples are kept in registers and stored together */
+		history = data + i;
+		m1 = history[-1]; m2 = history[-2]; m3 = history[-3]; m4 = history[-4]; m5 = history[-5]; m6 = history[-6]; m7 = history[-7];
+		d0 = residual[i] + ((_mm_cvtsi128_si32(s) + q6*m7 + q5*m6 + q4*m5 + q3*m4 + q2*m3 + q1*m2 + q0*m1) >> lp_quantization);
+		d1 = residual[i+1] + ((_mm_extract_epi32(s, 1) + q6*m6 + q5*m5 + q4*m4 + q3*m3 + q2*m2 + q1*m1 + q0*d0) >> lp_quantization);
+		d2 = residual[i+2] + ((_mm_extract_epi32(s, 2) + q6*m5 + q5*m4 + q4*m3 + q3*m2 + q2*m1 + q1*d0 + q0*d1) >> lp_quantization);
+		d3 = residual[i+3] + ((_mm_extract_epi32(s, 3) + q6*m4 + q5*m3 + q4*m2 + q3*m1 + q2*d0 + q1*d1 + q0*d2) >> lp_quantization);
+		_mm_storeu_si128((__m128i*)(data+i), _mm_setr_epi32(d0, d1, d2, d3));
+	}
+	for(; i < data_len; i++) {
+		sum = 0;
+		history = data + i;
+		for(j = 0; j < order; j++)
+			sum += qlp_coeff[j] * (*(--history));
+		data[i] = residual[i] + (sum >> lp_quantization);
+	}
+}
+
+FLAC__SSE41_TARGET
+void FLAC__lpc_restore_signal_intrin_sse41(const FLAC__int32 residual[], unsigned data_len, const FLAC__int32 qlp_coeff[], unsigned order, int lp_quantization, FLAC__int32 data[])
+{
+	FLAC__ASSERT(order > 0);
+	FLAC__ASSERT(order <= 32);
+
+	/* the C version also copes with a negative shift, which is not valid FLAC */
+	if(order < 10 || lp_quantization < 0) {
+		FLAC__lpc_restore_signal(residual, data_len, qlp_coeff, order, lp_quantization, data);
+		return;
+	}
+
+	switch(order) {
+		case 10: restore_signal_(residual, data_len, qlp_coeff, 10, lp_quantization, data); break;
+		case 11: restore_signal_(residual, data_len, qlp_coeff, 11, lp_quantization, data); break;
+		case 12: restore_signal_(residual, data_len, qlp_coeff, 12, lp_quantization, data); break;
+		default: restore_signal_(residual, data_len, qlp_coeff, order, lp_quantization, data); break;
+	}
+}
+
+#endif /* FLAC__HAS_X86INTRIN */
@@ -442,6 +442,18 @@ static FLAC__StreamDecoderInitStatus init_stream_internal_(
 			decoder->private_->local_lpc_restore_signal_16bit = FLAC__lpc_restore_signal_asm_ppc_altivec_16;
 			decoder->private_->local_lpc_restore_signal_16bit_order8 = FLAC__lpc_restore_signal_asm_ppc_altivec_16_order8;
 		}
+#elif defined FLAC__HAS_X86INTRIN
+		if(decoder->private_->cpuinfo.data.ia32.sse41) {
+			decoder->private_->local_lpc_restore_signal = FLAC__lpc_restore_signal_intrin_sse41;
+			decoder->private_->local_lpc_restore_signal_16bit = FLAC__lpc_restore_signal_intrin_sse41;
+			decoder->private_->local_lpc_restore_signal_16bit_order8 = FLAC__lpc_restore_signal_intrin_sse41;
+		}
+#elif defined FLAC__HAS_NEONINTRIN
+		if(decoder->private_->cpuinfo.data.arm.neon) {
+			decoder->private_->local_lpc_restore_signal = FLAC__lpc_restore_signal_intrin_neon;
+			decoder->private_->local_lpc_restore_signal_16bit = FLAC__lpc_restore_signal_intrin_neon;
+			decoder->private_->local_lpc_restore_signal_16bit_order8 = FLAC__lpc_restore_signal_intrin_neon;
+		}
 #endif
 	}
 #endif
@@ -42,6 +42,9 @@
 #include <fcntl.h> /* for _O_BINARY */
 #endif
 #include <limits.h>
+#ifdef FLAC__HAS_PTHREAD
+#include <pthread.h>
+#endif
 #include <stdio.h>
 #include <stdlib.h> /* for malloc() */
 #include <string.h> /* for memcpy() */
@@ -111,6 +114,22 @@ typedef struct {
 	unsigned bytes;
 } verify_output;
 
+#ifdef FLAC__HAS_PTHREAD
+/* Most threads FLAC__stream_encoder_set_num_threads() will start */
+#define MAX_THREADS_ 64
+
+/* A frame queued for, or encoded by, the worker threads */
+typedef struct {
+	FLAC__StreamEncoder *encoder; /* encodes this slot's frames into its own frame bitwriter */
+	unsigned blocksize;
+	unsigned frame_number;
+	FLAC__bool is_fractional_block;
+	FLAC__bool is_last_block;
+	FLAC__bool done; /* the frame is in encoder->private_->frame, or encoding failed */
+	FLAC__bool ok;
+} frame_slot;
+#endif
+
 typedef enum {
 	ENCODER_IN_MAGIC = 0,
 	ENCODER_IN_METADATA = 1,
@@ -157,7 +176,14 @@ static void update_metadata_(const FLAC__StreamEncoder *encoder);
 static void update_ogg_metadata_(FLAC__StreamEncoder *encoder);
 #endif
 static FLAC__bool process_frame_(FLAC__StreamEncoder *encoder, FLAC__bool is_fractional_block, FLAC__bool is_last_block);
+static FLAC__bool encode_frame_(FLAC__StreamEncoder *encoder, FLAC__bool is_fractional_block);
 static FLAC__bool process_subframes_(FLAC__StreamEncoder *encoder, FLAC__bool is_fractional_block);
+#ifdef FLAC__HAS_PTHREAD
+static void start_threads_(FLAC__StreamEncoder *encoder);
+static void stop_threads_(FLAC__StreamEncoder *encoder);
+static FLAC__bool queue_frame_(FLAC__StreamEncoder *encoder, FLAC__bool is_fractional_block, FLAC__bool is_last_block);
+static FLAC__bool write_queued_frame_(FLAC__StreamEncoder *encoder);
+#endif
 
 static FLAC__bool process_subframe_(
 	FLAC__StreamEncoder *encoder,
@@ -373,6 +399,7 @@ typedef struct FLAC__StreamEncoderPrivate {
 	unsigned (*local_fixed_compute_best_predictor)(const FLAC__int32 data[], unsigned data_len, FLAC__fixedpoint residual_bits_per_sample[FLAC__MAX_FIXED_ORDER+1]);
 #endif
 #ifndef FLAC__INTEGER_ONLY_LIBRARY
+	void (*local_lpc_window_data)(const FLAC__int32 in[], const FLAC__real window[], FLAC__real out[], unsigned data_len);
 	void (*local_lpc_compute_autocorrelation)(const FLAC__real data[], unsigned data_len, unsigned lag, FLAC__real autoc[]);
 	void (*local_lpc_compute_residual_from_qlp_coefficients)(const FLAC__int32 *data, unsigned data_len, const FLAC__int32 qlp_coeff[], unsigned order, int lp_quantization, FLAC__int32 residual[]);
 	void (*local_lpc_compute_residual_from_qlp_coefficients_64bit)(const FLAC__int32 *data, unsigned data_len, const FLAC__int32 qlp_coeff[], unsigned order, int lp_quantization, FLAC__int32 residual[]);
@@ -439,6 +466,24 @@ typedef struct FLAC__StreamEncoderPrivate {
 			FLAC__int32 got;
 		} error_stats;
 	} verify;
+#ifdef FLAC__HAS_PTHREAD
+	/*
+	 * The worker threads, if encoding frames in parallel; frames are
+	 * numbered from 0 in the order queued, and slot n%num_slots holds
+	 * frame n from when it is queued until it is written
+	 */
+	struct {
+		frame_slot *slots;
+		unsigned num_slots;          /* 0 if encoding on the caller's thread */
+		pthread_t *thread;
+		unsigned num_threads;        /* number started */
+		pthread_mutex_t mutex;
+		pthread_cond_t queued_cond;  /* signalled when a frame is queued, or the threads are to quit */
+		pthread_cond_t done_cond;    /* signalled when a frame is done */
+		unsigned queued, taken, written; /* counts of frames queued, taken by a worker, and written */
+		FLAC__bool quit;
+	} threads;
+#endif
 	FLAC__bool is_being_deleted; /* if true, call to ..._finish() from ..._delete() will not call the callbacks */
 } FLAC__StreamEncoderPrivate;
 
@@ -907,6 +952,7 @@ static FLAC__StreamEncoderInitStatus init_stream_internal_(
 	FLAC__cpu_info(&encoder->private_->cpuinfo);
 	/* first default to the non-asm routines */
 #ifndef FLAC__INTEGER_ONLY_LIBRARY
+	encoder->private_->local_lpc_window_data = FLAC__lpc_window_data;
 	encoder->private_->local_lpc_compute_autocorrelation = FLAC__lpc_compute_autocorrelation;
 #endif
 	encoder->private_->local_fixed_compute_best_predictor = FLAC__fixed_compute_best_predictor;
@@ -947,6 +993,30 @@ static FLAC__StreamEncoderInitStatus init_stream_internal_(
 		if(encoder->private_->cpuinfo.data.ia32.mmx && encoder->private_->cpuinfo.data.ia32.cmov)
 			encoder->private_->local_fixed_compute_best_predictor = FLAC__fixed_compute_best_predictor_asm_ia32_mmx_cmov;
 #   endif /* FLAC__HAS_NASM */
+#  elif defined FLAC__HAS_X86INTRIN
+		if(encoder->private_->cpuinfo.data.ia32.avx2) {
+			encoder->private_->local_lpc_window_data = FLAC__lpc_window_data_intrin_avx2;
+			encoder->private_->local_lpc_compute_autocorrelation = FLAC__lpc_compute_autocorrelation_intrin_avx2;
+			encoder->private_->local_lpc_compute_residual_from_qlp_coefficients = FLAC__lpc_compute_residual_from_qlp_coefficients_intrin_avx2;
+			encoder->private_->local_lpc_compute_residual_from_qlp_coefficients_16bit = FLAC__lpc_compute_residual_from_qlp_coefficients_intrin_avx2;
+		}
+		else {
+			if(encoder->private_->cpuinfo.data.ia32.sse2) {
+				encoder->private_->local_lpc_window_data = FLAC__lpc_window_data_intrin_sse2;
+				encoder->private_->local_lpc_compute_autocorrelation = FLAC__lpc_compute_autocorrelation_intrin_sse2;
+			}
+			if(encoder->private_->cpuinfo.data.ia32.sse41) {
+				encoder->private_->local_lpc_compute_residual_from_qlp_coefficients = FLAC__lpc_compute_residual_from_qlp_coefficients_intrin_sse41;
+				encoder->private_->local_lpc_compute_residual_from_qlp_coefficients_16bit = FLAC__lpc_compute_residual_from_qlp_coefficients_intrin_sse41;
+			}
+		}
+#  elif defined FLAC__HAS_NEONINTRIN
+		if(encoder->private_->cpuinfo.data.arm.neon) {
+			encoder->private_->local_lpc_window_data = FLAC__lpc_window_data_intrin_neon;
+			encoder->private_->local_lpc_compute_autocorrelation = FLAC__lpc_compute_autocorrelation_intrin_neon;
+			encoder->private_->local_lpc_compute_residual_from_qlp_coefficients = FLAC__lpc_compute_residual_from_qlp_coefficients_intrin_neon;
+			encoder->private_->local_lpc_compute_residual_from_qlp_coefficients_16bit = FLAC__lpc_compute_residual_from_qlp_coefficients_intrin_neon;
+		}
 #  endif /* FLAC__CPU_IA32 */
 	}
 # endif /* !FLAC__NO_ASM */
@@ -1135,6 +1205,10 @@ static FLAC__StreamEncoderInitStatus init_stream_internal_(
 	if(encoder->protected_->verify)
 		encoder->private_->verify.state_hint = ENCODER_IN_AUDIO;
 
+#ifdef FLAC__HAS_PTHREAD
+	start_threads_(encoder);
+#endif
+
 	return FLAC__STREAM_ENCODER_INIT_STATUS_OK;
 }
 
@@ -1331,6 +1405,12 @@ FLAC_API FLAC__bool FLAC__stream_encoder_finish(FLAC__StreamEncoder *encoder)
 			if(!process_frame_(encoder, is_fractional_block, /*is_last_block=*/true))
 				error = true;
 		}
+#ifdef FLAC__HAS_PTHREAD
+		while(!error && encoder->private_->threads.written != encoder->private_->threads.queued) {
+			if(!write_queued_frame_(encoder))
+				error = true;
+		}
+#endif
 	}
 
 	if(encoder->protected_->do_md5)
@@ -1372,6 +1452,10 @@ FLAC_API FLAC__bool FLAC__stream_encoder_finish(FLAC__StreamEncoder *encoder)
 		FLAC__ogg_encoder_aspect_finish(&encoder->protected_->ogg_encoder_aspect);
 #endif
 
+#ifdef FLAC__HAS_PTHREAD
+	stop_threads_(encoder);
+#endif
+
 	free_(encoder);
 	set_defaults_(encoder);
 
@@ -1714,6 +1798,17 @@ FLAC_API FLAC__bool FLAC__stream_encoder_set_total_samples_estimate(FLAC__Stream
 	return true;
 }
 
+FLAC_API FLAC__bool FLAC__stream_encoder_set_num_threads(FLAC__StreamEncoder *encoder, unsigned value)
+{
+	FLAC__ASSERT(0 != encoder);
+	FLAC__ASSERT(0 != encoder->private_);
+	FLAC__ASSERT(0 != encoder->protected_);
+	if(encoder->protected_->state != FLAC__STREAM_ENCODER_UNINITIALIZED)
+		return false;
+	encoder->protected_->num_threads = value;
+	return true;
+}
+
 FLAC_API FLAC__bool FLAC__stream_encoder_set_metadata(FLAC__StreamEncoder *encoder, FLAC__StreamMetadata **metadata, unsigned num_blocks)
 {
 	FLAC__ASSERT(0 != encoder);
@@ -1976,6 +2071,14 @@ FLAC_API FLAC__uint64 FLAC__stream_encoder_get_total_samples_estimate(const FLAC
 	return encoder->protected_->total_samples_estimate;
 }
 
+FLAC_API unsigned FLAC__stream_encoder_get_num_threads(const FLAC__StreamEncoder *encoder)
+{
+	FLAC__ASSERT(0 != encoder);
+	FLAC__ASSERT(0 != encoder->private_);
+	FLAC__ASSERT(0 != encoder->protected_);
+	return encoder->protected_->num_threads;
+}
+
 FLAC_API FLAC__bool FLAC__stream_encoder_process(FLAC__StreamEncoder *encoder, const FLAC__int32 * const buffer[], unsigned samples)
 {
 	unsigned i, j = 0, channel;
@@ -2147,6 +2250,7 @@ void set_defaults_(FLAC__StreamEncoder *encoder)
 	encoder->protected_->max_residual_partition_order = 0;
 	encoder->protected_->rice_parameter_search_dist = 0;
 	encoder->protected_->total_samples_estimate = 0;
+	encoder->protected_->num_threads = 1;
 	encoder->protected_->metadata = 0;
 	encoder->protected_->num_metadata_blocks = 0;
 
@@ -2869,7 +2973,6 @@ void update_ogg_metadata_(FLAC__StreamEncoder *encoder)
 
 FLAC__bool process_frame_(FLAC__StreamEncoder *encoder, FLAC__bool is_fractional_block, FLAC__bool is_last_block)
 {
-	FLAC__uint16 crc;
 	FLAC__ASSERT(encoder->protected_->state == FLAC__STREAM_ENCODER_OK);
 
 	/*
@@ -2880,6 +2983,51 @@ FLAC__bool process_frame_(FLAC__StreamEncoder *encoder, FLAC__bool is_fractional
 		return false;
 	}
 
+#ifdef FLAC__HAS_PTHREAD
+	/*
+	 * Hand it to the worker threads, if there are any, to be encoded while we carry on
+	 */
+	if(encoder->private_->threads.num_slots > 0) {
+		if(!queue_frame_(encoder, is_fractional_block, is_last_block)) {
+			/* the above function sets the state for us in case of an error */
+			return false;
+		}
+	}
+	else
+#endif
+	{
+		/*
+		 * Encode it
+		 */
+		if(!encode_frame_(encoder, is_fractional_block)) {
+			/* the above function sets the state for us in case of an error */
+			return false;
+		}
+
+		/*
+		 * Write it
+		 */
+		if(!write_bitbuffer_(encoder, encoder->protected_->blocksize, is_last_block)) {
+			/* the above function sets the state for us in case of an error */
+			return false;
+		}
+	}
+
+	/*
+	 * Get ready for the next frame
+	 */
+	encoder->private_->current_sample_number = 0;
+	encoder->private_->current_frame_number++;
+	encoder->private_->streaminfo.data.stream_info.total_samples += (FLAC__uint64)encoder->protected_->blocksize;
+
+	return true;
+}
+
+/* Encodes the frame in integer_signal[] (and integer_signal_mid_side[]) into the frame bitbuffer */
+FLAC__bool encode_frame_(FLAC__StreamEncoder *encoder, FLAC__bool is_fractional_block)
+{
+	FLAC__uint16 crc;
+
 	/*
 	 * Process the frame header and subframes into the frame bitbuffer
 	 */
@@ -2908,24 +3056,203 @@ FLAC__bool process_frame_(FLAC__StreamEncoder *encoder, FLAC__bool is_fractional
 		return false;
 	}
 
-	/*
-	 * Write it
-	 */
-	if(!write_bitbuffer_(encoder, encoder->protected_->blocksize, is_last_block)) {
-		/* the above function sets the state for us in case of an error */
-		return false;
+	return true;
+}
+
+#ifdef FLAC__HAS_PTHREAD
+/* The worker encoders' only writes are of the metadata from their init */
+static FLAC__StreamEncoderWriteStatus discard_write_callback_(const FLAC__StreamEncoder *encoder, const FLAC__byte buffer[], size_t bytes, unsigned samples, unsigned current_frame, void *client_data)
+{
+	(void)encoder, (void)buffer, (void)bytes, (void)samples, (void)current_frame, (void)client_data;
+	return FLAC__STREAM_ENCODER_WRITE_STATUS_OK;
+}
+
+/* Makes an encoder with the same settings as the given one, to encode frames for it */
+static FLAC__StreamEncoder *new_worker_encoder_(const FLAC__StreamEncoder *encoder)
+{
+	FLAC__StreamEncoder *worker = FLAC__stream_encoder_new();
+
+	if(0 == worker)
+		return 0;
+
+	*worker->protected_ = *encoder->protected_;
+	worker->protected_->state = FLAC__STREAM_ENCODER_UNINITIALIZED;
+	worker->protected_->verify = false;
+	worker->protected_->do_md5 = false;
+	worker->protected_->total_samples_estimate = 0;
+	worker->protected_->num_threads = 1;
+	worker->protected_->metadata = 0;
+	worker->protected_->num_metadata_blocks = 0;
+	worker->private_->disable_constant_subframes = encoder->private_->disable_constant_subframes;
+	worker->private_->disable_fixed_subframes = encoder->private_->disable_fixed_subframes;
+	worker->private_->disable_verbatim_subframes = encoder->private_->disable_verbatim_subframes;
+
+	if(FLAC__stream_encoder_init_stream(worker, discard_write_callback_, 0, 0, 0, 0) != FLAC__STREAM_ENCODER_INIT_STATUS_OK) {
+		FLAC__stream_encoder_delete(worker);
+		return 0;
 	}
+	return worker;
+}
 
-	/*
-	 * Get ready for the next frame
-	 */
-	encoder->private_->current_sample_number = 0;
-	encoder->private_->current_frame_number++;
-	encoder->private_->streaminfo.data.stream_info.total_samples += (FLAC__uint64)encoder->protected_->blocksize;
+static void *worker_thread_(void *arg)
+{
+	FLAC__StreamEncoder *encoder = (FLAC__StreamEncoder*)arg;
+	frame_slot *slot;
+	FLAC__bool ok;
+
+	pthread_mutex_lock(&encoder->private_->threads.mutex);
+	for(;;) {
+		while(!encoder->private_->threads.quit && encoder->private_->threads.taken == encoder->private_->threads.queued)
+			pthread_cond_wait(&encoder->private_->threads.queued_cond, &encoder->private_->threads.mutex);
+		if(encoder->private_->threads.quit)
+			break;
+		slot = &encoder->private_->threads.slots[encoder->private_->threads.taken++ % encoder->private_->threads.num_slots];
+		pthread_mutex_unlock(&encoder->private_->threads.mutex);
+
+		slot->encoder->protected_->blocksize = slot->blocksize;
+		slot->encoder->private_->current_frame_number = slot->frame_number;
+		ok = encode_frame_(slot->encoder, slot->is_fractional_block);
+
+		pthread_mutex_lock(&encoder->private_->threads.mutex);
+		slot->ok = ok;
+		slot->done = true;
+		pthread_cond_signal(&encoder->private_->threads.done_cond);
+	}
+	pthread_mutex_unlock(&encoder->private_->threads.mutex);
+	return 0;
+}
+
+/* Starts the worker threads, if more than one thread was asked for; if they can't be started, frames are encoded serially */
+void start_threads_(FLAC__StreamEncoder *encoder)
+{
+	const unsigned num_threads = min(encoder->protected_->num_threads, MAX_THREADS_);
+	const unsigned num_slots = 2 * num_threads; /* enough to keep every thread busy while frames are written in order */
+	unsigned i;
+
+	/* the worker encoders have no verify decoders, and loose mid-side stereo depends on the previous frame */
+	if(num_threads < 2 || encoder->protected_->verify || encoder->protected_->loose_mid_side_stereo)
+		return;
+
+	encoder->private_->threads.slots = (frame_slot*)calloc(num_slots, sizeof(frame_slot));
+	encoder->private_->threads.thread = (pthread_t*)calloc(num_threads, sizeof(pthread_t));
+	if(0 == encoder->private_->threads.slots || 0 == encoder->private_->threads.thread) {
+		free(encoder->private_->threads.slots);
+		free(encoder->private_->threads.thread);
+		memset(&encoder->private_->threads, 0, sizeof(encoder->private_->threads));
+		return;
+	}
+	pthread_mutex_init(&encoder->private_->threads.mutex, 0);
+	pthread_cond_init(&encoder->private_->threads.queued_cond, 0);
+	pthread_cond_init(&encoder->private_->threads.done_cond, 0);
+	encoder->private_->threads.num_slots = num_slots;
+
+	for(i = 0; i < num_slots; i++) {
+		if(0 == (encoder->private_->threads.slots[i].encoder = new_worker_encoder_(encoder))) {
+			stop_threads_(encoder);
+			return;
+		}
+	}
+	for(i = 0; i < num_threads; i++, encoder->private_->threads.num_threads++) {
+		if(pthread_create(&encoder->private_->threads.thread[i], 0, worker_thread_, encoder) != 0)
+			break;
+	}
+	if(encoder->private_->threads.num_threads == 0)
+		stop_threads_(encoder);
+}
+
+/* Stops the worker threads, abandoning any frames not yet written */
+void stop_threads_(FLAC__StreamEncoder *encoder)
+{
+	unsigned i;
+
+	if(0 == encoder->private_->threads.slots)
+		return;
+
+	pthread_mutex_lock(&encoder->private_->threads.mutex);
+	encoder->private_->threads.quit = true;
+	pthread_cond_broadcast(&encoder->private_->threads.queued_cond);
+	pthread_mutex_unlock(&encoder->private_->threads.mutex);
+	for(i = 0; i < encoder->private_->threads.num_threads; i++)
+		pthread_join(encoder->private_->threads.thread[i], 0);
+
+	for(i = 0; i < encoder->private_->threads.num_slots; i++) {
+		if(0 != encoder->private_->threads.slots[i].encoder)
+			FLAC__stream_encoder_delete(encoder->private_->threads.slots[i].encoder);
+	}
+	pthread_cond_destroy(&encoder->private_->threads.done_cond);
+	pthread_cond_destroy(&encoder->private_->threads.queued_cond);
+	pthread_mutex_destroy(&encoder->private_->threads.mutex);
+	free(encoder->private_->threads.slots);
+	free(encoder->private_->threads.thread);
+	memset(&encoder->private_->threads, 0, sizeof(encoder->private_->threads));
+}
+
+/* Queues the frame in integer_signal[] (and integer_signal_mid_side[]) for the worker threads */
+FLAC__bool queue_frame_(FLAC__StreamEncoder *encoder, FLAC__bool is_fractional_block, FLAC__bool is_last_block)
+{
+	const unsigned blocksize = encoder->protected_->blocksize;
+	frame_slot *slot;
+	unsigned channel;
+
+	/* with every slot in use, the oldest frame must be written to free one */
+	if(encoder->private_->threads.queued - encoder->private_->threads.written == encoder->private_->threads.num_slots) {
+		if(!write_queued_frame_(encoder))
+			return false;
+	}
+
+	slot = &encoder->private_->threads.slots[encoder->private_->threads.queued % encoder->private_->threads.num_slots];
+	for(channel = 0; channel < encoder->protected_->channels; channel++)
+		memcpy(slot->encoder->private_->integer_signal[channel], encoder->private_->integer_signal[channel], sizeof(FLAC__int32) * blocksize);
+	if(encoder->protected_->do_mid_side_stereo) {
+		for(channel = 0; channel < 2; channel++)
+			memcpy(slot->encoder->private_->integer_signal_mid_side[channel], encoder->private_->integer_signal_mid_side[channel], sizeof(FLAC__int32) * blocksize);
+	}
+	slot->blocksize = blocksize;
+	slot->frame_number = encoder->private_->current_frame_number;
+	slot->is_fractional_block = is_fractional_block;
+	slot->is_last_block = is_last_block;
+	slot->done = false;
+
+	pthread_mutex_lock(&encoder->private_->threads.mutex);
+	encoder->private_->threads.queued++;
+	pthread_cond_signal(&encoder->private_->threads.queued_cond);
+	pthread_mutex_unlock(&encoder->private_->threads.mutex);
 
 	return true;
 }
 
+/* Waits for the oldest queued frame to be encoded, and writes it */
+FLAC__bool write_queued_frame_(FLAC__StreamEncoder *encoder)
+{
+	frame_slot *slot = &encoder->private_->threads.slots[encoder->private_->threads.written % encoder->private_->threads.num_slots];
+	FLAC__BitWriter *frame = encoder->private_->frame;
+	const unsigned blocksize = encoder->protected_->blocksize, frame_number = encoder->private_->current_frame_number;
+	FLAC__bool ok;
+
+	pthread_mutex_lock(&encoder->private_->threads.mutex);
+	while(!slot->done)
+		pthread_cond_wait(&encoder->private_->threads.done_cond, &encoder->private_->threads.mutex);
+	pthread_mutex_unlock(&encoder->private_->threads.mutex);
+	encoder->private_->threads.written++;
+
+	if(!slot->ok) {
+		encoder->protected_->state = slot->encoder->protected_->state;
+		return false;
+	}
+
+	/* write_bitbuffer_() takes the frame, and for the seek table & write callback its blocksize & number, from the encoder */
+	encoder->private_->frame = slot->encoder->private_->frame;
+	encoder->protected_->blocksize = slot->blocksize;
+	encoder->private_->current_frame_number = slot->frame_number;
+	ok = write_bitbuffer_(encoder, slot->blocksize, slot->is_last_block);
+	encoder->private_->frame = frame;
+	encoder->protected_->blocksize = blocksize;
+	encoder->private_->current_frame_number = frame_number;
+
+	return ok;
+}
+#endif
+
 FLAC__bool process_subframes_(FLAC__StreamEncoder *encoder, FLAC__bool is_fractional_block)
 {
 	FLAC__FrameHeader frame_header;
@@ -3306,7 +3633,7 @@ FLAC__bool process_subframe_(
 				if(max_lpc_order > 0) {
 					unsigned a;
 					for (a = 0; a < encoder->protected_->num_apodizations; a++) {
-						FLAC__lpc_window_data(integer_signal, encoder->private_->window[a], encoder->private_->windowed_signal, frame_header->blocksize);
+						encoder->private_->local_lpc_window_data(integer_signal, encoder->private_->window[a], encoder->private_->windowed_signal, frame_header->blocksize);
 						encoder->private_->local_lpc_compute_autocorrelation(encoder->private_->windowed_signal, frame_header->blocksize, max_lpc_order+1, autoc);
 						/* if autoc[0] == 0.0, the signal is constant and we usually won't get here, but it can happen */
 						if(autoc[0] != 0.0) {
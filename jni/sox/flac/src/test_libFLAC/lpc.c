@@ -0,0 +1,261 @@
+/* test_libFLAC - Unit tester for libFLAC
+ * Copyright (C) 2000,2001,2002,2003,2004,2005,2006,2007  Josh Coalson
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#if HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include "FLAC/assert.h"
+#include "private/bitmath.h" /* from the libFLAC private include area */
+#include "private/cpu.h"
+#include "private/lpc.h"
+#include "lpc.h"
+#include <math.h> /* for fabs() */
+#include <stdio.h>
+#include <string.h> /* for memcmp() */
+
+/*
+ * Checks the routines selected by the CPU info in place of the C ones in
+ * lpc.c against them, on pseudo-random data of every order and of lengths
+ * either side of the vector widths.  All but the autocorrelation must give
+ * exactly the same result.
+ */
+
+#define MAX_LEN 4608
+
+typedef void (*window_fn)(const FLAC__int32 in[], const FLAC__real window[], FLAC__real out[], unsigned data_len);
+typedef void (*autoc_fn)(const FLAC__real data[], unsigned data_len, unsigned lag, FLAC__real autoc[]);
+typedef void (*residual_fn)(const FLAC__int32 *data, unsigned data_len, const FLAC__int32 qlp_coeff[], unsigned order, int lp_quantization, FLAC__int32 residual[]);
+typedef void (*restore_fn)(const FLAC__int32 residual[], unsigned data_len, const FLAC__int32 qlp_coeff[], unsigned order, int lp_quantization, FLAC__int32 data[]);
+
+static const unsigned lengths_[] = { 1, 2, 3, 4, 5, 7, 8, 9, 15, 16, 17, 31, 32, 33, 100, 1152, 4096, MAX_LEN };
+
+static FLAC__uint32 seed_ = 12345;
+
+static FLAC__int32 random_(unsigned bits)
+{
+	seed_ = seed_ * 1664525 + 1013904223;
+	return (FLAC__int32)seed_ >> (32 - bits);
+}
+
+static FLAC__int32 signal_[FLAC__MAX_LPC_ORDER + MAX_LEN];
+static FLAC__int32 restored_[FLAC__MAX_LPC_ORDER + MAX_LEN];
+static FLAC__int32 residual_ref_[MAX_LEN];
+
+/* a random walk, so the signal looks a little like audio */
+static void make_signal_(unsigned len, unsigned bits)
+{
+	const FLAC__int32 max = (1 << (bits - 1)) - 1;
+	FLAC__int32 x = 0;
+	unsigned i;
+
+	for(i = 0; i < FLAC__MAX_LPC_ORDER + len; i++) {
+		x += random_(bits - 3);
+		if(x > max) x = max;
+		if(x < -max) x = -max;
+		signal_[i] = x;
+	}
+}
+
+static int random_qlp_coeff_(FLAC__int32 qlp_coeff[], unsigned order, unsigned bits)
+{
+	/* keep the sum within 32 bits, as the codec does for these routines */
+	const unsigned precision = 32 - bits - FLAC__bitmath_ilog2(order) - 1;
+	const unsigned max_shift = precision - 1 < 16? precision - 1 : 16;
+	unsigned i;
+
+	for(i = 0; i < order; i++)
+		qlp_coeff[i] = random_(precision);
+	return (int)((order * 5) % max_shift);
+}
+
+#ifndef FLAC__INTEGER_ONLY_LIBRARY
+
+static FLAC__int32 in_[MAX_LEN], residual_[MAX_LEN];
+static FLAC__real window_[MAX_LEN], out_[MAX_LEN], out_ref_[MAX_LEN];
+static FLAC__real autoc_[FLAC__MAX_LPC_ORDER + 1], autoc_ref_[FLAC__MAX_LPC_ORDER + 1];
+
+static FLAC__bool test_window_data_(const char *name, window_fn fn)
+{
+	unsigned l, i;
+
+	printf("testing FLAC__lpc_window_data_%s()... ", name);
+	for(l = 0; l < sizeof(lengths_)/sizeof(lengths_[0]); l++) {
+		const unsigned len = lengths_[l];
+		for(i = 0; i < len; i++) {
+			in_[i] = random_(24);
+			window_[i] = (FLAC__real)(random_(24) & 0xffffff) / 16777216.0f;
+		}
+		FLAC__lpc_window_data(in_, window_, out_ref_, len);
+		fn(in_, window_, out_, len);
+		if(memcmp(out_, out_ref_, sizeof(FLAC__real) * len)) {
+			printf("FAILED, data_len=%u\n", len);
+			return false;
+		}
+	}
+	printf("OK\n");
+	return true;
+}
+
+static FLAC__bool test_compute_autocorrelation_(const char *name, autoc_fn fn)
+{
+	unsigned l, lag, i;
+
+	printf("testing FLAC__lpc_compute_autocorrelation_%s()... ", name);
+	for(l = 0; l < sizeof(lengths_)/sizeof(lengths_[0]); l++) {
+		const unsigned len = lengths_[l];
+		for(i = 0; i < len; i++)
+			out_[i] = (FLAC__real)random_(16);
+		for(lag = 1; lag <= FLAC__MAX_LPC_ORDER + 1 && lag <= len; lag++) {
+			FLAC__lpc_compute_autocorrelation(out_, len, lag, autoc_ref_);
+			fn(out_, len, lag, autoc_);
+			for(i = 0; i < lag; i++) {
+				/* the sums may be rounded differently; autoc[0] is the largest */
+				if(fabs(autoc_[i] - autoc_ref_[i]) > 1e-5 * fabs(autoc_ref_[0])) {
+					printf("FAILED, data_len=%u lag=%u autoc[%u]=%g expected %g\n", len, lag, i, autoc_[i], autoc_ref_[i]);
+					return false;
+				}
+			}
+		}
+	}
+	printf("OK\n");
+	return true;
+}
+
+static FLAC__bool test_compute_residual_(const char *name, residual_fn fn)
+{
+	static const unsigned bits[] = { 8, 16, 24 };
+	FLAC__int32 qlp_coeff[FLAC__MAX_LPC_ORDER];
+	unsigned l, b, order;
+	int shift;
+
+	printf("testing FLAC__lpc_compute_residual_from_qlp_coefficients_%s()... ", name);
+	for(l = 0; l < sizeof(lengths_)/sizeof(lengths_[0]); l++) {
+		const unsigned len = lengths_[l];
+		for(b = 0; b < sizeof(bits)/sizeof(bits[0]); b++) {
+			make_signal_(len, bits[b]);
+			for(order = 1; order <= FLAC__MAX_LPC_ORDER; order++) {
+				shift = random_qlp_coeff_(qlp_coeff, order, bits[b]);
+				FLAC__lpc_compute_residual_from_qlp_coefficients(signal_+FLAC__MAX_LPC_ORDER, len, qlp_coeff, order, shift, residual_ref_);
+				fn(signal_+FLAC__MAX_LPC_ORDER, len, qlp_coeff, order, shift, residual_);
+				if(memcmp(residual_, residual_ref_, sizeof(FLAC__int32) * len)) {
+					printf("FAILED, data_len=%u bps=%u order=%u shift=%d\n", len, bits[b], order, shift);
+					return false;
+				}
+			}
+		}
+	}
+	printf("OK\n");
+	return true;
+}
+
+#endif /* !FLAC__INTEGER_ONLY_LIBRARY */
+
+/* restoring the residual must give back the signal */
+static FLAC__bool test_restore_signal_(const char *name, restore_fn fn)
+{
+	static const unsigned bits[] = { 8, 16, 24 };
+	FLAC__int32 qlp_coeff[FLAC__MAX_LPC_ORDER];
+	unsigned l, b, order, i, j;
+	int shift;
+
+	printf("testing FLAC__lpc_restore_signal_%s()... ", name);
+	for(l = 0; l < sizeof(lengths_)/sizeof(lengths_[0]); l++) {
+		const unsigned len = lengths_[l];
+		for(b = 0; b < sizeof(bits)/sizeof(bits[0]); b++) {
+			make_signal_(len, bits[b]);
+			for(order = 1; order <= FLAC__MAX_LPC_ORDER; order++) {
+				shift = random_qlp_coeff_(qlp_coeff, order, bits[b]);
+				for(i = 0; i < len; i++) {
+					FLAC__int64 sum = 0;
+					for(j = 0; j < order; j++)
+						sum += (FLAC__int64)qlp_coeff[j] * signal_[FLAC__MAX_LPC_ORDER+i-j-1];
+					residual_ref_[i] = signal_[FLAC__MAX_LPC_ORDER+i] - (FLAC__int32)(sum >> shift);
+				}
+				memcpy(restored_, signal_, sizeof(FLAC__int32) * FLAC__MAX_LPC_ORDER);
+				memset(restored_+FLAC__MAX_LPC_ORDER, 0x55, sizeof(FLAC__int32) * len);
+				fn(residual_ref_, len, qlp_coeff, order, shift, restored_+FLAC__MAX_LPC_ORDER);
+				if(memcmp(restored_, signal_, sizeof(FLAC__int32) * (FLAC__MAX_LPC_ORDER + len))) {
+					printf("FAILED, data_len=%u bps=%u order=%u shift=%d\n", len, bits[b], order, shift);
+					return false;
+				}
+			}
+		}
+	}
+	printf("OK\n");
+	return true;
+}
+
+FLAC__bool test_lpc(void)
+{
+	FLAC__CPUInfo cpuinfo;
+
+	printf("\n+++ libFLAC unit test: lpc\n\n");
+
+	FLAC__cpu_info(&cpuinfo);
+
+	if(!test_restore_signal_("c", FLAC__lpc_restore_signal))
+		return false;
+
+#if defined FLAC__HAS_X86INTRIN
+	if(cpuinfo.use_asm) {
+# ifndef FLAC__INTEGER_ONLY_LIBRARY
+		if(cpuinfo.data.ia32.sse2) {
+			if(!test_window_data_("intrin_sse2", FLAC__lpc_window_data_intrin_sse2))
+				return false;
+			if(!test_compute_autocorrelation_("intrin_sse2", FLAC__lpc_compute_autocorrelation_intrin_sse2))
+				return false;
+		}
+		if(cpuinfo.data.ia32.sse41) {
+			if(!test_compute_residual_("intrin_sse41", FLAC__lpc_compute_residual_from_qlp_coefficients_intrin_sse41))
+				return false;
+		}
+		if(cpuinfo.data.ia32.avx2) {
+			if(!test_window_data_("intrin_avx2", FLAC__lpc_window_data_intrin_avx2))
+				return false;
+			if(!test_compute_autocorrelation_("intrin_avx2", FLAC__lpc_compute_autocorrelation_intrin_avx2))
+				return false;
+			if(!test_compute_residual_("intrin_avx2", FLAC__lpc_compute_residual_from_qlp_coefficients_intrin_avx2))
+				return false;
+		}
+# endif
+		if(cpuinfo.data.ia32.sse41) {
+			if(!test_restore_signal_("intrin_sse41", FLAC__lpc_restore_signal_intrin_sse41))
+				return false;
+		}
+	}
+#elif defined FLAC__HAS_NEONINTRIN
+	if(cpuinfo.use_asm && cpuinfo.data.arm.neon) {
+# ifndef FLAC__INTEGER_ONLY_LIBRARY
+		if(!test_window_data_("intrin_neon", FLAC__lpc_window_data_intrin_neon))
+			return false;
+		if(!test_compute_autocorrelation_("intrin_neon", FLAC__lpc_compute_autocorrelation_intrin_neon))
+			return false;
+		if(!test_compute_residual_("intrin_neon", FLAC__lpc_compute_residual_from_qlp_coefficients_intrin_neon))
+			return false;
+# endif
+		if(!test_restore_signal_("intrin_neon", FLAC__lpc_restore_signal_intrin_neon))
+			return false;
+	}
+#else
+	(void)cpuinfo;
+#endif
+
+	printf("\nPASSED!\n");
+	return true;
+}
@@ -24,6 +24,7 @@
 #include "decoders.h"
 #include "encoders.h"
 #include "format.h"
+#include "lpc.h"
 #include "metadata.h"
 
 int main(int argc, char *argv[])
@@ -36,6 +37,9 @@ int main(int argc, char *argv[])
 	if(!test_format())
 		return 1;
 
+	if(!test_lpc())
+		return 1;
+
 	if(!test_encoders())
 		return 1;
 
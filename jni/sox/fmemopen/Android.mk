@@ -4,8 +4,10 @@ include $(CLEAR_VARS)
 
 LOCAL_MODULE := libfmemopen
 LOCAL_ARM_MODE := arm
+LOCAL_ARM_NEON := $(SOX_ARM_NEON)
 LOCAL_SRC_FILES := fmemopen.c open_memstream.c
 
+LOCAL_CFLAGS := $(SOX_CFLAGS)
 LOCAL_LDLIBS := -ldl -lGLESv1_CM -llog -L$(DIRECTORY_TO_OBJ)
 
 include $(BUILD_SHARED_LIBRARY)
@@ -5,6 +5,7 @@ include $(CLEAR_VARS)
 
 LOCAL_MODULE := libmp3lame
 LOCAL_ARM_MODE := arm
+LOCAL_ARM_NEON := $(SOX_ARM_NEON)
 LOCAL_C_INCLUDES := $(LOCAL_PATH)/../include
 
 LOCAL_SRC_FILES := bitstream.c \
@@ -28,7 +29,14 @@ LOCAL_SRC_FILES := bitstream.c \
 	mpglib_interface.c \
         VbrTag.c \
 
-LOCAL_CFLAGS           := -Wall -g
+LOCAL_CFLAGS           := -Wall $(SOX_CFLAGS) -DSTDC_HEADERS -DHAVE_STDINT_H
+
+# SSE quantisation and IEEE-754 float tricks, as lame's configure enables on x86
+ifneq ($(filter x86 x86_64,$(TARGET_ARCH_ABI)),)
+LOCAL_CFLAGS += -DHAVE_XMMINTRIN_H -DTAKEHIRO_IEEE754_HACK
+LOCAL_C_INCLUDES += $(LOCAL_PATH)/vector
+LOCAL_SRC_FILES += vector/xmm_quantize_sub.c
+endif
 LOCAL_LDFLAGS          := -Wl,-Map,xxx.map
 LOCAL_LDLIBS := -ldl -lGLESv1_CM -llog -L$(DIRECTORY_TO_OBJ)
 
@@ -5,13 +5,24 @@ include $(CLEAR_VARS)
 
 LOCAL_MODULE := libmad
 LOCAL_ARM_MODE := arm
+LOCAL_ARM_NEON := $(SOX_ARM_NEON)
 LOCAL_C_INCLUDES := $(LOCAL_PATH) \
 
 LOCAL_SRC_FILES := version.c fixed.c bit.c timer.c stream.c frame.c  \
-                   synth.c decoder.c layer12.c layer3.c huffman.c  imdct_l_arm.S \
+                   synth.c decoder.c layer12.c layer3.c huffman.c \
 
 LOCAL_SHARED_LIBRARIES := liblpc10 libgsm
-LOCAL_CFLAGS           := -Wall -g
+LOCAL_CFLAGS           := -Wall $(SOX_CFLAGS) -DHAVE_CONFIG_H
+
+# Fixed-point multiply: as libmad's configure would choose for each CPU
+ifeq ($(TARGET_ARCH_ABI),armeabi-v7a)
+LOCAL_CFLAGS += -DFPM_ARM -DASO_INTERLEAVE1 -DASO_IMDCT
+LOCAL_SRC_FILES += imdct_l_arm.S
+else ifeq ($(TARGET_ARCH_ABI),x86)
+LOCAL_CFLAGS += -DFPM_INTEL
+else
+LOCAL_CFLAGS += -DFPM_64BIT
+endif
 LOCAL_LDFLAGS          := -Wl,-Map,xxx.map
 LOCAL_LDLIBS := -ldl -lGLESv1_CM -llog -L$(DIRECTORY_TO_OBJ)
 
@@ -5,13 +5,14 @@ include $(CLEAR_VARS)
 LOCAL_MODULE := libogg
 
 LOCAL_ARM_MODE := arm
+LOCAL_ARM_NEON := $(SOX_ARM_NEON)
 LOCAL_C_INCLUDES := $(LOCAL_PATH) \
 $(LOCAL_PATH)/../include/
 
 
 LOCAL_SRC_FILES := framing.c bitwise.c
 
-LOCAL_CFLAGS           := -Wall -g
+LOCAL_CFLAGS           := -Wall $(SOX_CFLAGS)
 LOCAL_LDFLAGS          := -Wl,-Map,xxx.map
 include $(BUILD_SHARED_LIBRARY)
 
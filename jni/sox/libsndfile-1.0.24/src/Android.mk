@@ -4,6 +4,7 @@ LOCAL_PATH := $(call my-dir)
 include $(CLEAR_VARS)
 
 LOCAL_ARM_MODE := arm
+LOCAL_ARM_NEON := $(SOX_ARM_NEON)
 
 LOCAL_MODULE := libsndfile
 
@@ -22,7 +23,7 @@ LOCAL_SRC_FILES := common.c file_io.c command.c pcm.c ulaw.c alaw.c float32.c \
 		sds.c svx.c txw.c voc.c wve.c w64.c wav_w64.c wav.c xi.c mpc2k.c rf64.c
 
 LOCAL_SHARED_LIBRARIES := liblpc10 libgsm libogg libvorbis libvorbisenc libsmrx libsmr libFLAC
-LOCAL_CFLAGS           := -Wall -g
+LOCAL_CFLAGS           := -Wall $(SOX_CFLAGS)
 LOCAL_LDFLAGS          := -Wl,-Map,xxx.map
 LOCAL_LDLIBS := -ldl -lGLESv1_CM -llog -L$(DIRECTORY_TO_OBJ)
 
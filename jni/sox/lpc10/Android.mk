@@ -3,6 +3,7 @@ LOCAL_PATH := $(call my-dir)
 include $(CLEAR_VARS)
 
 LOCAL_ARM_MODE := arm
+LOCAL_ARM_NEON := $(SOX_ARM_NEON)
 
 LOCAL_MODULE := liblpc10
 
@@ -15,7 +16,7 @@ LOCAL_SRC_FILES := analys.c bsynz.c chanwr.c dcbias.c \
                    lpfilt.c median.c mload.c onset.c pitsyn.c placea.c placev.c preemp.c \
                    prepro.c random.c rcchk.c synths.c tbdm.c voicin.c vparms.c
 
-LOCAL_CFLAGS           := -Wall -g
+LOCAL_CFLAGS           := -Wall $(SOX_CFLAGS)
 LOCAL_LDFLAGS          := -Wl,-Map,xxx.map
 LOCAL_LDLIBS := -ldl -lGLESv1_CM -llog -L$(DIRECTORY_TO_OBJ)
 
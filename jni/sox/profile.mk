@@ -0,0 +1,37 @@
+# Build profile shared by every module under jni/sox (included before them).
+#
+# Modules add $(SOX_CFLAGS) to LOCAL_CFLAGS and set LOCAL_ARM_NEON from
+# $(SOX_ARM_NEON); anything ABI-specific that only one library cares about
+# (e.g. libmad's FPM_* choice) stays in that library's Android.mk, keyed on
+# TARGET_ARCH_ABI.
+#
+# APP_OPTIM=release (the default) gives optimised code without debug info;
+# APP_OPTIM=debug gives unoptimised code with it.  jni/host/Makefile reads
+# this file too, with TARGET_ARCH_ABI set for the host.
+
+ifeq ($(APP_OPTIM),debug)
+SOX_CFLAGS := -O0 -g
+else
+SOX_CFLAGS := -O3 -DNDEBUG -fomit-frame-pointer
+endif
+
+SOX_ARM_NEON :=
+
+ifeq ($(TARGET_ARCH_ABI),armeabi-v7a)
+# NEON is optional in the v7-a ABI but present on all devices we target
+SOX_ARM_NEON := true
+endif
+
+# The hand-written NEON kernels have yet to be checked on a device against
+# the C code they replace, so they are built only on request, with
+# ndk-build SOX_NEON_KERNELS=true.  They are in:
+#   tempo (overlap search), rate (FIRs), biquad (--fuse-biquads cascades),
+#   pcmconv (raw s16/s24/f32 conversion), libFLAC (LPC)
+ifeq ($(SOX_NEON_KERNELS),true)
+SOX_CFLAGS += -DSOX_NEON_KERNELS -DFLAC__USE_NEONINTRIN
+endif
+
+ifeq ($(TARGET_ARCH_ABI),x86_64)
+# Guaranteed by the Android x86_64 ABI
+SOX_CFLAGS += -msse4.2 -mpopcnt
+endif
@@ -4,6 +4,7 @@ include $(CLEAR_VARS)
 
 LOCAL_MODULE := libsox
 LOCAL_ARM_MODE := arm
+LOCAL_ARM_NEON := $(SOX_ARM_NEON)
 LOCAL_C_INCLUDES := $(LOCAL_PATH) \
 $(LOCAL_PATH)/../libogg/include/ \
 $(LOCAL_PATH)/../vorbis/include/ \
@@ -19,12 +20,12 @@ $(LOCAL_PATH)/../libgsm/ \
 $(LOCAL_PATH)/../lpc10/ \
 $(LOCAL_PATH)/../../android_external_alsa-lib/include/ \
 
-LOCAL_CFLAGS           := -Wall -g
+LOCAL_CFLAGS           := -Wall $(SOX_CFLAGS)
 LOCAL_LDFLAGS          := -Wl,-Map,xxx.map
 
 LOCAL_SRC_FILES := sox.c adpcms.c aiff.c cvsd.c \
 	g711.c g721.c g723_24.c g723_40.c g72x.c vox.c \
-        raw.c formats.c formats_i.c skelform.c \
+        raw.c formats.c formats_i.c pcmconv.c skelform.c \
 	xmalloc.c getopt.c getopt1.c \
 	util.c libsox.c libsox_i.c sox-fmt.c \
         bend.c biquad.c biquads.c chorus.c compand.c crop.c \
@@ -43,7 +44,7 @@ LOCAL_SRC_FILES := sox.c adpcms.c aiff.c cvsd.c \
         lu-fmt.c 8svx.c aiff-fmt.c aifc-fmt.c au.c avr.c cdr.c cvsd-fmt.c \
         dvms-fmt.c dat.c hcom.c htk.c maud.c prc.c sf.c smp.c \
         sounder.c soundtool.c sphere.c tx16w.c voc.c vox-fmt.c ima-fmt.c adpcm.c \
-        ima_rw.c wav.c wve.c xa.c nulfile.c f4-fmt.c f8-fmt.c gsrt.c vorbis.c gsm.c flac.c lpc10.c mp3.c wavpack.c ffmpeg.c sndfile.c caf.c fap.c mat4.c mat5.c paf.c pvf.c sd2.c    w64.c xi.c   \
+        ima_rw.c wav.c wve.c xa.c nulfile.c ring.c f4-fmt.c f8-fmt.c gsrt.c vorbis.c gsm.c flac.c lpc10.c mp3.c wavpack.c ffmpeg.c sndfile.c caf.c fap.c mat4.c mat5.c paf.c pvf.c sd2.c    w64.c xi.c   \
 
 LOCAL_SHARED_LIBRARIES := liblpc10 libgsm libfmemopen libogg libvorbis libvorbisenc libvorbisfile libFLAC libmp3lame libmad libpng libsndfile libwavpack
 LOCAL_LDLIBS := -ldl -llog -lGLESv1_CM -lavformat -lswscale -lavcodec -lavutil -L$(DIRECTORY_TO_OBJ)
@@ -69,6 +69,7 @@ static int start(sox_effect_t * effp)
   p->a1 /= p->a0;
 
   p->o2 = p->o1 = p->i2 = p->i1 = 0;
+  lsx_effect_set_float(effp, lsx_biquad_flow_f, NULL);
   return SOX_SUCCESS;
 }
 
@@ -136,6 +137,20 @@ int lsx_biquad_flow(sox_effect_t * effp, const sox_sample_t *ibuf,
   return SOX_SUCCESS;
 }
 
+int lsx_biquad_flow_f(sox_effect_t * effp, const float *ibuf,
+    float *obuf, size_t *isamp, size_t *osamp)
+{
+  priv_t * p = (priv_t *)effp->priv;
+  size_t len = *isamp = *osamp = min(*isamp, *osamp);
+  while (len--) {
+    double o0 = *ibuf*p->b0 + p->i1*p->b1 + p->i2*p->b2 - p->o1*p->a1 - p->o2*p->a2;
+    p->i2 = p->i1, p->i1 = *ibuf++;
+    p->o2 = p->o1, p->o1 = o0;
+    *obuf++ = o0;
+  }
+  return SOX_SUCCESS;
+}
+
 static int create(sox_effect_t * effp, int argc, char * * argv)
 {
   priv_t             * p = (priv_t *)effp->priv;
@@ -156,3 +171,228 @@ sox_effect_handler_t const * lsx_biquad_effect_fn(void)
   };
   return &handler;
 }
+
+
+/* If the chain has fuse_biquads set, consecutive biquad effects in it are
+ * fused by lsx_biquad_fuse into one multi-channel effect that runs them as a
+ * cascade, in transposed direct form II, a block at a time and one stage at
+ * a time: one pass over the audio and one int<->double conversion instead of
+ * one per biquad.  Channels
+ * go in the lanes of vectors of 2 doubles where the compiler targets SSE2
+ * (x86) or NEON (AArch64, with SOX_NEON_KERNELS: see profile.mk); a lone
+ * channel goes in both lanes so that every channel sees exactly the same
+ * arithmetic, whatever its number. */
+
+#if defined __SSE2__ || defined _M_X64 || (defined _M_IX86_FP && _M_IX86_FP >= 2)
+  #define HAVE_SSE2_BIQUAD
+  #include <emmintrin.h>
+#elif defined __aarch64__ && (defined __ARM_NEON__ || defined __ARM_NEON) && \
+    defined SOX_NEON_KERNELS
+  #define HAVE_NEON_BIQUAD
+  #include <arm_neon.h>
+#endif
+
+#define CASCADE_BLOCK 1024 /* Samples (not frames) converted at a time */
+
+typedef struct {
+  int      num_stages;
+  double   * coefs;        /* b0, b1, b2, a1, a2 for each stage */
+  double   * state;        /* For each stage, s1 then s2 for each channel */
+  size_t   block;          /* Whole frames of samples that fit in work */
+  double   * work;
+} cascade_t;
+
+#if defined HAVE_SSE2_BIQUAD
+  #define vec_t           __m128d
+  #define vec_set1        _mm_set1_pd
+  #define vec_load        _mm_loadu_pd
+  #define vec_load1       _mm_load1_pd
+  #define vec_store       _mm_storeu_pd
+  #define vec_store1      _mm_store_sd
+  #define vec_add         _mm_add_pd
+  #define vec_sub         _mm_sub_pd
+  #define vec_mul         _mm_mul_pd
+#elif defined HAVE_NEON_BIQUAD
+  #define vec_t           float64x2_t
+  #define vec_set1        vdupq_n_f64
+  #define vec_load        vld1q_f64
+  #define vec_load1       vld1q_dup_f64
+  #define vec_store       vst1q_f64
+  #define vec_store1(p, v) vst1q_lane_f64(p, v, 0)
+  #define vec_add         vaddq_f64
+  #define vec_sub         vsubq_f64
+  #define vec_mul         vmulq_f64
+#endif
+
+#ifdef vec_t
+
+/* One stage over len frames of chans channels at d, for the channel(s)
+ * whose state is at z[0] & z[chans]: two channels (load & store) or one */
+#define STAGE(name, load, store) \
+static void name(double const * k, double * z, unsigned chans, \
+    double * d, size_t len) \
+{ \
+  vec_t b0 = vec_set1(k[0]), b1 = vec_set1(k[1]), b2 = vec_set1(k[2]); \
+  vec_t a1 = vec_set1(k[3]), a2 = vec_set1(k[4]); \
+  vec_t s1 = load(z), s2 = load(z + chans), x, y; \
+  \
+  for (; len; --len, d += chans) { \
+    x = load(d); \
+    y = vec_add(vec_mul(b0, x), s1); \
+    s1 = vec_add(vec_sub(vec_mul(b1, x), vec_mul(a1, y)), s2); \
+    s2 = vec_sub(vec_mul(b2, x), vec_mul(a2, y)); \
+    store(d, y); \
+  } \
+  store(z, s1), store(z + chans, s2); \
+}
+
+STAGE(stage2, vec_load, vec_store)
+STAGE(stage1, vec_load1, vec_store1)
+
+#else
+
+static void stage1(double const * k, double * z, unsigned chans,
+    double * d, size_t len)
+{
+  double b0 = k[0], b1 = k[1], b2 = k[2], a1 = k[3], a2 = k[4];
+  double s1 = z[0], s2 = z[chans], x, y;
+
+  for (; len; --len, d += chans) {
+    x = *d;
+    y = b0 * x + s1;
+    s1 = b1 * x - a1 * y + s2;
+    s2 = b2 * x - a2 * y;
+    *d = y;
+  }
+  z[0] = s1, z[chans] = s2;
+}
+
+#endif
+
+static void cascade(cascade_t * p, unsigned chans, size_t len)
+{
+  size_t frames = len / chans;
+  int i;
+  unsigned c;
+
+  for (i = 0; i < p->num_stages; ++i) {
+    double const * k = p->coefs + 5 * i;
+    double * z = p->state + 2 * chans * i;
+
+    c = 0;
+#ifdef vec_t
+    for (; c + 2 <= chans; c += 2)
+      stage2(k, z + c, chans, p->work + c, frames);
+#endif
+    for (; c < chans; ++c)
+      stage1(k, z + c, chans, p->work + c, frames);
+  }
+}
+
+static int cascade_flow(sox_effect_t * effp, const sox_sample_t * ibuf,
+    sox_sample_t * obuf, size_t * isamp, size_t * osamp)
+{
+  cascade_t * p = (cascade_t *)effp->priv;
+  unsigned chans = effp->in_signal.channels;
+  size_t i, n, len = *isamp = *osamp = min(*isamp, *osamp);
+
+  for (; len; len -= n) {
+    n = min(len, p->block);
+    for (i = 0; i < n; ++i)
+      p->work[i] = *ibuf++;
+    cascade(p, chans, n);
+    for (i = 0; i < n; ++i)
+      *obuf++ = SOX_ROUND_CLIP_COUNT(p->work[i], effp->clips);
+  }
+  return SOX_SUCCESS;
+}
+
+static int cascade_flow_f(sox_effect_t * effp, const float * ibuf,
+    float * obuf, size_t * isamp, size_t * osamp)
+{
+  cascade_t * p = (cascade_t *)effp->priv;
+  unsigned chans = effp->in_signal.channels;
+  size_t i, n, len = *isamp = *osamp = min(*isamp, *osamp);
+
+  for (; len; len -= n) {
+    n = min(len, p->block);
+    for (i = 0; i < n; ++i)
+      p->work[i] = *ibuf++;
+    cascade(p, chans, n);
+    for (i = 0; i < n; ++i)
+      *obuf++ = p->work[i];
+  }
+  return SOX_SUCCESS;
+}
+
+static int cascade_stop(sox_effect_t * effp)
+{
+  cascade_t * p = (cascade_t *)effp->priv;
+
+  free(p->coefs);
+  free(p->state);
+  free(p->work);
+  return SOX_SUCCESS;
+}
+
+/* Appends the (started) biquad effp as the last stage of the cascade */
+static void add_stage(cascade_t * p, sox_effect_t const * effp)
+{
+  biquad_t const * q = (biquad_t const *)effp->priv;
+  unsigned chans = effp->in_signal.channels;
+  double * k;
+
+  p->coefs = lsx_realloc(p->coefs, 5 * (p->num_stages + 1) * sizeof(*p->coefs));
+  k = p->coefs + 5 * p->num_stages++;
+  k[0] = q->b0, k[1] = q->b1, k[2] = q->b2, k[3] = q->a1, k[4] = q->a2;
+  free(p->state);
+  p->state = lsx_calloc(2 * chans * p->num_stages, sizeof(*p->state));
+  if (!p->work) {
+    p->block = max(CASCADE_BLOCK / chans, 1) * chans;
+    p->work = lsx_malloc(p->block * sizeof(*p->work));
+  }
+}
+
+/* Called by sox_add_effect when the chain has fuse_biquads set: if the
+ * chain's last two effects are biquads, or a cascade and a biquad, replaces
+ * them by one cascade.  Fusion is before any audio has flowed, so there is
+ * no filter state to carry over.  Unlike separate effects, the stages are
+ * not rounded and clipped to integer samples between them, and the fused
+ * effects are no longer in the chain under their own names. */
+void lsx_biquad_fuse(sox_effects_chain_t * chain)
+{
+  static sox_effect_handler_t const handler = {
+    "biquads", NULL, SOX_EFF_MCHAN,
+    NULL, NULL, cascade_flow, NULL, cascade_stop, NULL, sizeof(cascade_t)
+  };
+  sox_effect_t * * a, * effp;
+  cascade_t * p;
+
+  if (chain->length < 2)
+    return;
+  a = &chain->effects[chain->length - 2];
+  effp = chain->effects[chain->length - 1];
+  if (effp->handler.flow != lsx_biquad_flow ||
+      ((*a)->handler.flow != lsx_biquad_flow && (*a)->handler.flow != cascade_flow))
+    return;
+  if ((*a)->handler.flow == lsx_biquad_flow) {
+    sox_effect_t * c = sox_create_effect(&handler);
+
+    c->global_info = (*a)->global_info;
+    c->in_signal = (*a)->in_signal;
+    c->out_signal = (*a)->out_signal;
+    c->in_encoding = (*a)->in_encoding;
+    c->out_encoding = (*a)->out_encoding;
+    c->flows = 1;
+    lsx_effect_set_float(c, cascade_flow_f, NULL);
+    c->flow_float = (*a)->flow_float;
+    add_stage(c->priv, *a);
+    sox_delete_effect(*a);
+    *a = c;
+  }
+  p = (cascade_t *)(*a)->priv;
+  add_stage(p, effp);
+  lsx_debug("fused as stage %i of a cascade", p->num_stages);
+  sox_delete_effect(effp);
+  chain->effects[--chain->length] = NULL;
+}
@@ -64,7 +64,7 @@ typedef struct {
   double b0, b1, b2;       /* Filter coefficients */
   double a0, a1, a2;       /* Filter coefficients */
 
-  sox_sample_t i1, i2;     /* Filter memory */
+  double      i1, i2;      /* Filter memory */
   double      o1, o2;      /* Filter memory */
 } biquad_t;
 
@@ -74,5 +74,7 @@ int lsx_biquad_getopts(sox_effect_t * effp, int n, char **argv,
 int lsx_biquad_start(sox_effect_t * effp);
 int lsx_biquad_flow(sox_effect_t * effp, const sox_sample_t *ibuf, sox_sample_t *obuf,
                         size_t *isamp, size_t *osamp);
+int lsx_biquad_flow_f(sox_effect_t * effp, const float *ibuf, float *obuf,
+                        size_t *isamp, size_t *osamp);
 
 #endif
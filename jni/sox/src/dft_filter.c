@@ -36,17 +36,311 @@ void lsx_set_dft_filter(dft_filter_t *f, double *h, int n, int post_peak)
   free(h);
 }
 
+/* Filters are costly to design, so, since a chain (or many chains, in a
+ * long-running process) often needs the same one again, designed filters are
+ * kept in a process-wide cache.  An entry is keyed by the kind of filter and
+ * the parameters it was designed from; it is shared (read-only) by every user
+ * holding a reference.  Entries that are no longer referenced stay, most
+ * recently used first, until they take more than sox_globals.filter_cache_size
+ * bytes; the least recently used are then evicted. */
+
+typedef struct filter_cache_entry {
+  struct filter_cache_entry * next;
+  char const   * kind;
+  double       * key;
+  int          key_len, refs;
+  size_t       size;          /* Bytes at filter.coefs */
+  dft_filter_t filter;
+} entry_t;
+
+static entry_t * filter_cache;       /* Most recently used first */
+static size_t filter_cache_unused;   /* Bytes in entries with no references */
+#if defined HAVE_PTHREAD_H
+  #include <pthread.h>
+  static pthread_mutex_t filter_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+  #define filter_cache_set_lock()   pthread_mutex_lock(&filter_cache_lock)
+  #define filter_cache_unset_lock() pthread_mutex_unlock(&filter_cache_lock)
+#else
+  static omp_lock_t filter_cache_lock;
+  #define filter_cache_set_lock()   omp_set_lock(&filter_cache_lock)
+  #define filter_cache_unset_lock() omp_unset_lock(&filter_cache_lock)
+#endif
+
+void init_filter_cache(void)
+{
+#if !defined HAVE_PTHREAD_H
+  omp_init_lock(&filter_cache_lock);
+#endif
+}
+
+static void delete_entry(entry_t * e)
+{
+  free(e->filter.coefs);
+  free(e->key);
+  free(e);
+}
+
+void clear_filter_cache(void)
+{
+  while (filter_cache) {
+    entry_t * e = filter_cache;
+    filter_cache = e->next;
+    delete_entry(e);
+  }
+  filter_cache_unused = 0;
+#if !defined HAVE_PTHREAD_H
+  omp_destroy_lock(&filter_cache_lock);
+#endif
+}
+
+/* Call with the lock held.  Unlinks the entry, moving it to the front. */
+static entry_t * find_entry(char const * kind, double const * key, int key_len)
+{
+  entry_t * * e;
+
+  for (e = &filter_cache; *e; e = &(*e)->next)
+    if ((*e)->key_len == key_len && !strcmp((*e)->kind, kind) &&
+        !memcmp((*e)->key, key, key_len * sizeof(*key))) {
+      entry_t * found = *e;
+      *e = found->next;
+      found->next = filter_cache;
+      return filter_cache = found;
+    }
+  return NULL;
+}
+
+static void take_reference(entry_t * e, dft_filter_t * f)
+{
+  if (!e->refs++)
+    filter_cache_unused -= e->size;
+  *f = e->filter;
+}
+
+/* Call with the lock held */
+static void evict(void)
+{
+  while (filter_cache_unused > sox_globals.filter_cache_size) {
+    entry_t * * e, * * last = NULL, * victim;
+
+    for (e = &filter_cache; *e; e = &(*e)->next)
+      if (!(*e)->refs)
+        last = e;
+    if (!last)
+      break;
+    victim = *last;
+    *last = victim->next;
+    filter_cache_unused -= victim->size;
+    delete_entry(victim);
+  }
+}
+
+/* If a filter with the given kind and design parameters is in the cache, takes
+ * a reference to it in *f and returns sox_true */
+sox_bool lsx_find_filter(dft_filter_t * f,
+    char const * kind, double const * key, int key_len)
+{
+  entry_t * e;
+
+  filter_cache_set_lock();
+  if ((e = find_entry(kind, key, key_len)) != NULL)
+    take_reference(e, f);
+  filter_cache_unset_lock();
+  return e != NULL;
+}
+
+/* Hands the newly designed filter *f (with num_coefs coefs) to the cache;
+ * the caller's reference to it is released with lsx_release_filter as usual.
+ * If another thread has cached the same filter meanwhile, f is switched to
+ * that one. */
+void lsx_cache_filter(dft_filter_t * f,
+    char const * kind, double const * key, int key_len, size_t num_coefs)
+{
+  entry_t * e;
+
+  filter_cache_set_lock();
+  if ((e = find_entry(kind, key, key_len)) != NULL) {
+    free(f->coefs);
+    take_reference(e, f);
+  }
+  else {
+    e = lsx_calloc(1, sizeof(*e));
+    e->kind = kind;
+    e->key = lsx_malloc(key_len * sizeof(*key));
+    memcpy(e->key, key, key_len * sizeof(*key));
+    e->key_len = key_len;
+    e->refs = 1;
+    e->size = num_coefs * sizeof(*f->coefs);
+    e->filter = *f;
+    e->next = filter_cache;
+    filter_cache = e;
+  }
+  filter_cache_unset_lock();
+}
+
+/* Drops a reference taken by lsx_find_filter or lsx_cache_filter; coefs that
+ * were never cached are simply freed */
+void lsx_release_filter(double * coefs)
+{
+  entry_t * e;
+
+  if (!coefs)
+    return;
+  filter_cache_set_lock();
+  for (e = filter_cache; e && e->filter.coefs != coefs; e = e->next);
+  if (e && !--e->refs) {
+    filter_cache_unused += e->size;
+    evict();
+  }
+  filter_cache_unset_lock();
+  if (!e)
+    free(coefs);
+}
+
+/* With sox_globals.filter_block set, a filter whose DFT would take in more than
+ * that many samples at a time is instead split into partitions, each applied
+ * by DFT to blocks of input as long as itself (overlap-save).  The first
+ * partition is of length n, the largest power of 2 within filter_block, so
+ * output can be given every n samples.  Later partitions may double in length,
+ * since a partition of length s starting at tap s - n or later has until then
+ * to produce its contribution to the output; a level of equal partitions
+ * shares one pair of DFTs per block.  So latency is bounded by n while long
+ * filters are still mostly applied by long DFTs.  The output of each level is
+ * summed in acc, a ring buffer indexed by time. */
+
+/* The relative cost per sample of a level of partitions of length s, as
+ * measured on x86-64: its pair of DFTs about 4 log2(2s), each partition
+ * about 3 */
+static int level_cost(int s, int num_parts)
+{
+  int cost = 3 * num_parts;
+  for (s <<= 1; s > 1; s >>= 1)
+    cost += 4;
+  return cost;
+}
+
+/* sox_globals.filter_block if set, but no less than SOX_BUFMIN */
+static size_t filter_block(void)
+{
+  size_t n = sox_globals.filter_block;
+  return n && n < SOX_BUFMIN? SOX_BUFMIN : n;
+}
+
+static void partition(priv_t * p)
+{
+  filter_t const * f = p->filter_ptr;
+  int i, j, n = 1, s, offset = 0;
+  double * h = lsx_memdup(f->coefs, f->dft_length * sizeof(*h));
+
+  while (2 * (size_t)n <= filter_block())
+    n <<= 1;
+  lsx_safe_rdft(f->dft_length, -1, h); /* Back to the taps */
+  p->levels = lsx_calloc(32, sizeof(*p->levels)); /* Ample, as s doubles */
+  for (s = n; offset < f->num_taps; s <<= 1) {
+    dft_filter_level_t * l = &p->levels[p->num_levels++];
+    int rest = f->num_taps - offset;
+
+    l->length = s;
+    l->offset = offset;
+    l->num_parts = (rest + s - 1) / s;    /* Unless a longer level is cheaper: */
+    if (rest > s &&
+        3 + level_cost(2 * s, (rest + s - 1) / (2 * s)) < 3 * l->num_parts)
+      l->num_parts = 1;
+    l->coefs = lsx_calloc(l->num_parts * 2 * s, sizeof(*l->coefs));
+    l->dfts = lsx_calloc(l->num_parts * 2 * s, sizeof(*l->dfts));
+    for (i = 0; i < min(rest, l->num_parts * s); ++i)
+      l->coefs[i / s * 2 * s + i % s] = h[(offset + i + f->dft_length -
+          f->num_taps + 1) & (f->dft_length - 1)] / s;
+    for (j = 0; j < l->num_parts; ++j)
+      lsx_safe_rdft(2 * s, 1, l->coefs + j * 2 * s);
+    lsx_debug("level=%i length=%i offset=%i partitions=%i",
+        p->num_levels - 1, s, offset, l->num_parts);
+    offset += l->num_parts * s;
+  }
+  for (i = 1; i <= f->num_taps + n; i <<= 1);
+  p->acc_mask = i - 1;
+  p->acc_pos = 0;
+  p->acc = lsx_calloc(i, sizeof(*p->acc));
+  p->work = lsx_malloc(2 * (s >> 1) * sizeof(*p->work));
+  p->step = 0;
+  p->skip = f->num_taps - 1; /* To align the output as filter() does */
+  free(h);
+}
+
 static int start(sox_effect_t * effp)
 {
   priv_t * p = (priv_t *) effp->priv;
+  int preload = p->filter_ptr->post_peak;
 
+  p->num_levels = 0;
+  if (filter_block() &&
+      (size_t)p->filter_ptr->dft_length > 2 * filter_block()) {
+    partition(p);  /* Preload the longest level's first history too: */
+    preload += 2 * p->levels[p->num_levels - 1].length - p->levels[0].length;
+  }
   fifo_create(&p->input_fifo, (int)sizeof(double));
-  memset(fifo_reserve(&p->input_fifo,
-        p->filter_ptr->post_peak), 0, sizeof(double) * p->filter_ptr->post_peak);
+  memset(fifo_reserve(&p->input_fifo, preload), 0, sizeof(double) * preload);
   fifo_create(&p->output_fifo, (int)sizeof(double));
   return SOX_SUCCESS;
 }
 
+/* Adds to acc the output of level l, from the input block ending at `end' */
+static void filter_level(priv_t * p, dft_filter_level_t * l, double const * end)
+{
+  int i, j, s = l->length, dft_length = 2 * s;
+  double * dft = l->dfts + l->part_num * dft_length, * work = p->work;
+  unsigned pos = p->acc_pos + p->levels[0].length + l->offset - s;
+
+  memcpy(dft, end - dft_length, dft_length * sizeof(*dft));
+  lsx_safe_rdft(dft_length, 1, dft);
+  memset(work, 0, dft_length * sizeof(*work));
+  for (j = 0; j < l->num_parts; ++j) { /* Partition j with the jth last block */
+    double const * c = l->coefs + j * dft_length;
+    double const * d = l->dfts +
+      (l->part_num + l->num_parts - j) % l->num_parts * dft_length;
+    work[0] += c[0] * d[0];
+    work[1] += c[1] * d[1];
+    for (i = 2; i < dft_length; i += 2) {
+      work[i  ] += c[i  ] * d[i] - c[i+1] * d[i+1];
+      work[i+1] += c[i+1] * d[i] + c[i  ] * d[i+1];
+    }
+  }
+  lsx_safe_rdft(dft_length, -1, work);
+  for (i = 0; i < s; ++i)           /* The second half is the valid output */
+    p->acc[(pos + i) & p->acc_mask] += work[s + i];
+  l->part_num = (l->part_num + 1) % l->num_parts;
+}
+
+static void filter_partitioned(priv_t * p)
+{
+  int i, n = p->levels[0].length;
+  int window = 2 * p->levels[p->num_levels - 1].length;
+  int num_in = max(0, fifo_occupancy(&p->input_fifo));
+  double * output;
+
+  while (num_in >= window) {
+    double const * end = (double *)fifo_read_ptr(&p->input_fifo) + window;
+
+    ++p->step;      /* Each level takes a block when it has one complete */
+    for (i = 0; i < p->num_levels &&
+        !(p->step & (unsigned)(p->levels[i].length / n - 1)); ++i)
+      filter_level(p, &p->levels[i], end);
+    fifo_read(&p->input_fifo, n, NULL);
+    num_in -= n;
+
+    output = fifo_reserve(&p->output_fifo, n);
+    for (i = 0; i < n; ++i) {
+      output[i] = p->acc[p->acc_pos];
+      p->acc[p->acc_pos] = 0;
+      p->acc_pos = (p->acc_pos + 1) & p->acc_mask;
+    }
+  }
+  if (p->skip) {
+    i = min(p->skip, fifo_occupancy(&p->output_fifo));
+    fifo_read(&p->output_fifo, i, NULL);
+    p->skip -= i;
+  }
+}
+
 static void filter(priv_t * p)
 {
   int i, num_in = max(0, fifo_occupancy(&p->input_fifo));
@@ -54,6 +348,10 @@ static void filter(priv_t * p)
   int const overlap = f->num_taps - 1;
   double * output;
 
+  if (p->num_levels) {
+    filter_partitioned(p);
+    return;
+  }
   while (num_in >= f->dft_length) {
     double const * input = fifo_read_ptr(&p->input_fifo);
     fifo_read(&p->input_fifo, f->dft_length - overlap, NULL);
@@ -124,10 +422,19 @@ static int drain(sox_effect_t * effp, sox_sample_t * obuf, size_t * osamp)
 static int stop(sox_effect_t * effp)
 {
   priv_t * p = (priv_t *) effp->priv;
+  int i;
 
   fifo_delete(&p->input_fifo);
   fifo_delete(&p->output_fifo);
-  free(p->filter_ptr->coefs);
+  for (i = 0; i < p->num_levels; ++i) {
+    free(p->levels[i].coefs);
+    free(p->levels[i].dfts);
+  }
+  free(p->levels);
+  free(p->work);
+  free(p->acc);
+  p->levels = NULL, p->work = p->acc = NULL;
+  lsx_release_filter(p->filter_ptr->coefs);
   memset(p->filter_ptr, 0, sizeof(*p->filter_ptr));
   return SOX_SUCCESS;
 }
@@ -7,10 +7,24 @@ typedef struct {
   double     * coefs;
 } dft_filter_t;
 
+typedef struct {   /* Equal partitions of a filter, applied together */
+  int        length, offset, num_parts, part_num;
+  double     * coefs, * dfts;
+} dft_filter_level_t;
+
 typedef struct {
   size_t     samples_in, samples_out;
   fifo_t     input_fifo, output_fifo;
   dft_filter_t   filter, * filter_ptr;
+  int        num_levels, skip;            /* For partitioned convolution */
+  dft_filter_level_t * levels;
+  double     * work, * acc;
+  unsigned   acc_mask, acc_pos, step;
 } dft_filter_priv_t;
 
 void lsx_set_dft_filter(dft_filter_t * f, double * h, int n, int post_peak);
+sox_bool lsx_find_filter(dft_filter_t * f,
+    char const * kind, double const * key, int key_len);
+void lsx_cache_filter(dft_filter_t * f,
+    char const * kind, double const * key, int key_len, size_t num_coefs);
+void lsx_release_filter(double * coefs);
@@ -54,6 +54,12 @@ static int default_drain(sox_effect_t * effp UNUSED, sox_sample_t *obuf UNUSED,
   return SOX_EOF;
 }
 
+static int default_drain_f(sox_effect_t * effp UNUSED, float *obuf UNUSED, size_t *osamp)
+{
+  *osamp = 0;
+  return SOX_EOF;
+}
+
 /* Check that no parameters have been given */
 static int default_getopts(sox_effect_t * effp, int argc, char **argv UNUSED)
 {
@@ -105,8 +111,12 @@ sox_effects_chain_t * sox_create_effects_chain(
   return result;
 } /* sox_create_effects_chain */
 
+static void stop_flow(sox_effects_chain_t * chain, struct sox_flow_state * s);
+
 void sox_delete_effects_chain(sox_effects_chain_t *ecp)
 {
+    if (ecp && ecp->flow)
+        stop_flow(ecp, ecp->flow);
     if (ecp && ecp->length)
         sox_delete_effects(ecp);
     free(ecp);
@@ -124,6 +134,85 @@ int lsx_effect_set_imin(sox_effect_t * effp, size_t imin)
   return SOX_SUCCESS;
 }
 
+/* Effect can call in start() to offer native float versions of flow() and
+ * drain(); these see 32-bit floats with full scale at +-1, which need not be
+ * clipped.  They are used only if the chain has use_float set.  A NULL
+ * drain_f means that there is nothing to drain. */
+void lsx_effect_set_float(sox_effect_t * effp,
+    int (*flow_f)(sox_effect_t *, const float *, float *, size_t *, size_t *),
+    int (*drain_f)(sox_effect_t *, float *, size_t *))
+{
+  effp->flow_f = flow_f;
+  effp->drain_f = drain_f? drain_f : default_drain_f;
+}
+
+/* Effect can call in start() to accept parameter changes while running (see
+ * sox_effects_set_param).  set_param is called, for the first flow only, on
+ * the control thread.  With speed not NULL, it only checks the change,
+ * setting *speed if the change would make the effect's output need playing
+ * at a different rate (relative to out_signal.rate); with speed NULL, it
+ * makes the change, normally just by lsx_param_set so that the flows pick it
+ * up with lsx_param_get. */
+void lsx_effect_set_param(sox_effect_t * effp,
+    int (*set_param)(sox_effect_t *, char const *, double, double *))
+{
+  effp->set_param = set_param;
+}
+
+#if defined __GNUC__
+  #define param_barrier() __sync_synchronize()
+#else
+  #define param_barrier() (void)0
+#endif
+
+/* A sequence lock, so a double can be passed between threads without tearing
+ * and without the flow ever waiting; there is one writer at a time. */
+void lsx_param_set(lsx_param_t * p, double value)
+{
+  ++p->seq;
+  param_barrier();
+  p->value = value;
+  param_barrier();
+  ++p->seq;
+}
+
+/* Gets a value set since the last get, if there is one.  The value is taken
+ * from the first flow's slot at most once per step of the effect (by
+ * whichever flow gets first, as they may run concurrently), and every flow
+ * gets that value, so that every channel changes at the same point. */
+sox_bool lsx_param_get(sox_effect_t * effp, lsx_param_t * p, double * value)
+{
+  sox_effect_t const * effp0 = effp - effp->flow;
+  lsx_param_t * p0 = (lsx_param_t *)((char *)effp0->priv +
+      ((char *)p - (char *)effp->priv));
+  unsigned seq;
+  double v;
+  sox_bool got;
+
+#ifdef HAVE_OPENMP
+  #pragma omp critical (lsx_param)
+#endif
+  {
+    if (p0->step != effp0->step) {
+      p0->step = effp0->step;
+      if ((seq = p0->seq) != p0->taken_seq && !(seq & 1)) {
+        param_barrier();
+        v = p0->value;
+        param_barrier();
+        if (p0->seq == seq) { /* Else overwritten meanwhile; take it later */
+          p0->taken_seq = seq;
+          p0->taken = v;
+        }
+      }
+    }
+    if ((got = p->seen != p0->taken_seq)) {
+      p->seen = p0->taken_seq;
+      *value = p0->taken;
+    }
+  }
+  return got;
+}
+
 /* Add an effect to the chain. *in is the input signal for this effect. *out is
  * a suggestion as to what the output signal should be, but depending on its
  * given options and *in, the effect can choose to do differently.  Whatever
@@ -155,6 +244,10 @@ int sox_add_effect(sox_effects_chain_t * chain, sox_effect_t * effp, sox_signali
     (effp->handler.flags & SOX_EFF_MCHAN)? 1 : effp->in_signal.channels;
   effp->clips = 0;
   effp->imin = 0;
+  effp->flow_f = NULL;
+  effp->drain_f = NULL;
+  effp->set_param = NULL;
+  effp->adjustable = chain->adjustable;
   eff0 = *effp, eff0.priv = lsx_memdup(eff0.priv, eff0.handler.priv_size);
   eff0.in_signal.mult = NULL; /* Only used in channel 0 */
   ret = start(effp);
@@ -169,6 +262,7 @@ int sox_add_effect(sox_effects_chain_t * chain, sox_effect_t * effp, sox_signali
   }
   if (in->mult)
     lsx_debug("mult=%g", *in->mult);
+  effp->flow_float = chain->use_float && effp->flow_f;
 
   *in = effp->out_signal;
 
@@ -189,20 +283,110 @@ int sox_add_effect(sox_effects_chain_t * chain, sox_effect_t * effp, sox_signali
       free(eff0.priv);
       return SOX_EOF;
     }
+    chain->effects[chain->length][f].flow_float = effp->flow_float;
   }
 
   ++chain->length;
   free(eff0.priv);
+  if (chain->fuse_biquads) /* Consecutive biquads run faster as one effect */
+    lsx_biquad_fuse(chain);
   return SOX_SUCCESS;
 }
 
-static int flow_effect(sox_effects_chain_t * chain, size_t n)
+/* State of the flow/drain scheduler; kept in the chain between calls to
+ * sox_render_effects */
+struct sox_flow_state {
+  size_t e, source_e;        /* effect indices */
+  size_t max_flows;
+  sox_bool draining;
+  sox_bool stopped;          /* Last effect gave EOF; nothing more to come */
+  int status;
+  sox_sample_t * cbuf;       /* For int<->float conversion between effects */
+  sox_sample_t ** ibufc, ** obufc; /* Channel interleave buffers */
+  sox_bool planar[SOX_MAX_EFFECTS]; /* Effect's obuf is planar, not interleaved */
+  sox_effect_t * input;      /* If set, stands in for the previous effect */
+};
+
+/* Float-mode effects share the int buffers: the two types are the same size
+ * and the interleaving below just moves 32-bit words.  Conversion happens
+ * only where an int effect meets a float one. */
+typedef char float_fits_in_sample[sizeof(float) == sizeof(sox_sample_t)? 1 : -1];
+
+static void samples_to_float(sox_sample_t * buf, sox_sample_t const * ibuf, size_t len)
+{
+  float * obuf = (float *)buf;
+
+  while (len--)
+    *obuf++ = SOX_SAMPLE_TO_FLOAT_64BIT(*ibuf++,);
+}
+
+static void float_to_samples(sox_sample_t * obuf, sox_sample_t const * buf, size_t len, size_t * clips)
+{
+  float const * ibuf = (float const *)buf;
+  SOX_SAMPLE_LOCALS;
+
+  while (len--)
+    *obuf++ = SOX_FLOAT_64BIT_TO_SAMPLE(*ibuf++, *clips);
+}
+
+static int call_flow(sox_effect_t * effp, const sox_sample_t * ibuf,
+    sox_sample_t * obuf, size_t * isamp, size_t * osamp)
+{
+  return effp->flow_float?
+    effp->flow_f(effp, (float const *)ibuf, (float *)obuf, isamp, osamp) :
+    effp->handler.flow(effp, ibuf, obuf, isamp, osamp);
+}
+
+static int call_drain(sox_effect_t * effp, sox_sample_t * obuf, size_t * osamp)
 {
-  sox_effect_t * effp1 = &chain->effects[n - 1][0];
+  return effp->flow_float?
+    effp->drain_f(effp, (float *)obuf, osamp) :
+    effp->handler.drain(effp, obuf, osamp);
+}
+
+/* A planar buffer holds each channel in its own 1/flows of the buffer; obeg
+ * and oend still count samples across all channels */
+#define planar_chan(buf, flows, f) ((buf) + (f) * (sox_globals.bufsiz / (flows)))
+
+/* Convert between effects' int and float samples, keeping the layout.  The
+ * next effect might not take all of them, and those left are converted again
+ * next time, so clips are counted separately by count_clips. */
+static void convert(sox_effect_t * effp1, sox_bool planar, sox_sample_t * buf)
+{
+  size_t len = effp1->oend - effp1->obeg, f, flows = planar? effp1->flows : 1;
+  size_t clips = 0;
+
+  for (f = 0; f < flows; ++f) {
+    sox_sample_t * obuf = planar_chan(buf, flows, f) + effp1->obeg / flows;
+    sox_sample_t const * ibuf = planar_chan(effp1->obuf, flows, f) + effp1->obeg / flows;
+    if (effp1->flow_float)
+      float_to_samples(obuf, ibuf, len / flows, &clips);
+    else samples_to_float(obuf, ibuf, len / flows);
+  }
+}
+
+/* Count the clips in the first len (converted) float samples of effp1's
+ * output, once the next effect has taken them */
+static void count_clips(sox_effect_t * effp1, sox_bool planar, size_t len)
+{
+  size_t i, f, flows = planar? effp1->flows : 1;
+  SOX_SAMPLE_LOCALS;
+
+  for (f = 0; f < flows; ++f) {
+    float const * ibuf = (float const *)(planar_chan(effp1->obuf, flows, f) + effp1->obeg / flows);
+    for (i = 0; i < len / flows; ++i)
+      (void)SOX_FLOAT_64BIT_TO_SAMPLE(ibuf[i], effp1->clips);
+  }
+}
+
+static int flow_effect(sox_effects_chain_t * chain, struct sox_flow_state * s, size_t n)
+{
+  sox_effect_t * effp1 = s->input? s->input : &chain->effects[n - 1][0];
   sox_effect_t * effp = &chain->effects[n][0];
   int effstatus = SOX_SUCCESS, f = 0;
   size_t i;
-  const sox_sample_t *ibuf;
+  sox_bool planar_in = s->planar[n - 1], planar_out = s->planar[n];
+  const sox_sample_t *ibuf = effp1->obuf;
   size_t idone = effp1->oend - effp1->obeg;
   size_t obeg = sox_globals.bufsiz - effp->oend;
 #if DEBUG_EFFECTS_CHAIN
@@ -210,17 +394,22 @@ static int flow_effect(sox_effects_chain_t * chain, size_t n)
   size_t pre_odone = obeg;
 #endif
 
+  if (effp->flow_float != effp1->flow_float)
+    convert(effp1, planar_in, s->cbuf), ibuf = s->cbuf;
+
+  ++effp->step;
   if (effp->flows == 1)       /* Run effect on all channels at once */
-    effstatus = effp->handler.flow(effp, &effp1->obuf[effp1->obeg],
-                                   &effp->obuf[effp->oend], &idone, &obeg);
+    effstatus = call_flow(effp, &ibuf[effp1->obeg], &effp->obuf[effp->oend], &idone, &obeg);
   else {                 /* Run effect on each channel individually */
     sox_sample_t *obuf = &effp->obuf[effp->oend];
     size_t idone_last = 0, odone_last = 0; /* Initialised to prevent warning */
 
-    ibuf = &effp1->obuf[effp1->obeg];
-    for (i = 0; i < idone; i += effp->flows)
-      for (f = 0; f < (int)effp->flows; ++f)
-        chain->ibufc[f][i / effp->flows] = *ibuf++;
+    if (!planar_in) {
+      ibuf += effp1->obeg;
+      for (i = 0; i < idone; i += effp->flows)
+        for (f = 0; f < (int)effp->flows; ++f)
+          s->ibufc[f][i / effp->flows] = *ibuf++;
+    }
 
 #ifdef HAVE_OPENMP
     #pragma omp parallel for
@@ -228,8 +417,10 @@ static int flow_effect(sox_effects_chain_t * chain, size_t n)
     for (f = 0; f < (int)effp->flows; ++f) {
       size_t idonec = idone / effp->flows;
       size_t odonec = obeg / effp->flows;
-      int eff_status_c = effp->handler.flow(&chain->effects[n][f],
-          chain->ibufc[f], chain->obufc[f], &idonec, &odonec);
+      int eff_status_c = call_flow(&chain->effects[n][f], planar_in?
+          planar_chan(ibuf, effp->flows, f) + effp1->obeg / effp->flows : s->ibufc[f], planar_out?
+          planar_chan(effp->obuf, effp->flows, f) + effp->oend / effp->flows : s->obufc[f],
+          &idonec, &odonec);
 #ifndef HAVE_OPENMP
       if (f && (idonec != idone_last || odonec != odone_last)) {
         lsx_fail("flowed asymmetrically!");
@@ -248,9 +439,10 @@ static int flow_effect(sox_effects_chain_t * chain, size_t n)
         effstatus = SOX_EOF;
     }
 
-    for (i = 0; i < odone_last; ++i)
-      for (f = 0; f < (int)effp->flows; ++f)
-        *obuf++ = chain->obufc[f][i];
+    if (!planar_out)
+      for (i = 0; i < odone_last; ++i)
+        for (f = 0; f < (int)effp->flows; ++f)
+          *obuf++ = s->obufc[f][i];
 
     idone = effp->flows * idone_last;
     obeg = effp->flows * odone_last;
@@ -258,11 +450,17 @@ static int flow_effect(sox_effects_chain_t * chain, size_t n)
 #if DEBUG_EFFECTS_CHAIN
   lsx_report("flow:  %5u%5u%5u%5u", pre_idone, pre_odone, idone, obeg);
 #endif
+  if (effp1->flow_float && !effp->flow_float)
+    count_clips(effp1, planar_in, idone);
   effp1->obeg += idone;
   if (effp1->obeg == effp1->oend)
     effp1->obeg = effp1->oend = 0;
   else if (effp1->oend - effp1->obeg < effp->imin ) { /* Need to refill? */
-    memmove(effp1->obuf, &effp1->obuf[effp1->obeg], (effp1->oend - effp1->obeg) * sizeof(*effp1->obuf));
+    size_t flows = planar_in? effp1->flows : 1;
+    for (i = 0; i < flows; ++i)
+      memmove(planar_chan(effp1->obuf, flows, i),
+          planar_chan(effp1->obuf, flows, i) + effp1->obeg / flows,
+          (effp1->oend - effp1->obeg) / flows * sizeof(*effp1->obuf));
     effp1->oend -= effp1->obeg;
     effp1->obeg = 0;
   }
@@ -273,25 +471,29 @@ static int flow_effect(sox_effects_chain_t * chain, size_t n)
 }
 
 /* The same as flow_effect but with no input */
-static int drain_effect(sox_effects_chain_t * chain, size_t n)
+static int drain_effect(sox_effects_chain_t * chain, struct sox_flow_state * s, size_t n)
 {
   sox_effect_t * effp = &chain->effects[n][0];
   int effstatus = SOX_SUCCESS;
   size_t i, f;
+  sox_bool planar_out = s->planar[n];
   size_t obeg = sox_globals.bufsiz - effp->oend;
 #if DEBUG_EFFECTS_CHAIN
   size_t pre_odone = obeg;
 #endif
 
+  ++effp->step;
   if (effp->flows == 1)   /* Run effect on all channels at once */
-    effstatus = effp->handler.drain(effp, &effp->obuf[effp->oend], &obeg);
+    effstatus = call_drain(effp, &effp->obuf[effp->oend], &obeg);
   else {                         /* Run effect on each channel individually */
     sox_sample_t *obuf = &effp->obuf[effp->oend];
     size_t odone_last = 0; /* Initialised to prevent warning */
 
     for (f = 0; f < effp->flows; ++f) {
       size_t odonec = obeg / effp->flows;
-      int eff_status_c = effp->handler.drain(&chain->effects[n][f], chain->obufc[f], &odonec);
+      int eff_status_c = call_drain(&chain->effects[n][f], planar_out?
+          planar_chan(effp->obuf, effp->flows, f) + effp->oend / effp->flows : s->obufc[f],
+          &odonec);
       if (f && (odonec != odone_last)) {
         lsx_fail("drained asymmetrically!");
         effstatus = SOX_EOF;
@@ -302,9 +504,10 @@ static int drain_effect(sox_effects_chain_t * chain, size_t n)
         effstatus = SOX_EOF;
     }
 
-    for (i = 0; i < odone_last; ++i)
-      for (f = 0; f < effp->flows; ++f)
-        *obuf++ = chain->obufc[f][i];
+    if (!planar_out)
+      for (i = 0; i < odone_last; ++i)
+        for (f = 0; f < effp->flows; ++f)
+          *obuf++ = s->obufc[f][i];
     obeg = f * odone_last;
   }
 #if DEBUG_EFFECTS_CHAIN
@@ -318,69 +521,394 @@ static int drain_effect(sox_effects_chain_t * chain, size_t n)
   return effstatus == SOX_SUCCESS? SOX_SUCCESS : SOX_EOF;
 }
 
-/* Flow data through the effects chain until an effect or callback gives EOF */
-int sox_flow_effects(sox_effects_chain_t * chain, int (* callback)(sox_bool all_done, void * client_data), void * client_data)
+static struct sox_flow_state * new_flow_state(sox_effects_chain_t * chain)
 {
-  int flow_status = SOX_SUCCESS;
-  size_t e, source_e = 0;               /* effect indices */
-  size_t f, max_flows = 0;
-  sox_bool draining = sox_true;
+  struct sox_flow_state * s = lsx_calloc(1, sizeof(*s));
+  size_t e, f;
+
+  for (e = 0; e < chain->length; ++e)
+    s->max_flows = max(s->max_flows, chain->effects[e][0].flows);
+  s->ibufc = lsx_calloc(s->max_flows, sizeof(*s->ibufc));
+  s->obufc = lsx_calloc(s->max_flows, sizeof(*s->obufc));
+  for (f = 0; f < s->max_flows; ++f) {
+    s->ibufc[f] = lsx_calloc(sox_globals.bufsiz / 2, sizeof(s->ibufc[f][0]));
+    s->obufc[f] = lsx_calloc(sox_globals.bufsiz / 2, sizeof(s->obufc[f][0]));
+  }
+  if (chain->use_float)
+    s->cbuf = lsx_malloc(sox_globals.bufsiz * sizeof(*s->cbuf));
+  s->status = SOX_SUCCESS;
+  return s;
+}
+
+static void delete_flow_state(struct sox_flow_state * s)
+{
+  size_t f;
+
+  for (f = 0; f < s->max_flows; ++f) {
+    free(s->ibufc[f]);
+    free(s->obufc[f]);
+  }
+  free(s->obufc);
+  free(s->ibufc);
+  free(s->cbuf);
+  free(s);
+}
+
+static void alloc_obufs(sox_effects_chain_t * chain)
+{
+  size_t e;
 
   for (e = 0; e < chain->length; ++e) {
     chain->effects[e][0].obuf = lsx_malloc(sox_globals.bufsiz * sizeof(chain->effects[e][0].obuf[0]));
     chain->effects[e][0].obeg = chain->effects[e][0].oend = 0;
-    max_flows = max(max_flows, chain->effects[e][0].flows);
   }
+}
 
-  chain->ibufc = lsx_calloc(max_flows, sizeof(*chain->ibufc));
-  chain->obufc = lsx_calloc(max_flows, sizeof(*chain->obufc));
-  for (f = 0; f < max_flows; ++f) {
-    chain->ibufc[f] = lsx_calloc(sox_globals.bufsiz / 2, sizeof(chain->ibufc[f][0]));
-    chain->obufc[f] = lsx_calloc(sox_globals.bufsiz / 2, sizeof(chain->obufc[f][0]));
-  }
+static void free_obufs(sox_effects_chain_t * chain)
+{
+  size_t e;
+
+  for (e = 0; e < chain->length; ++e)
+    free(chain->effects[e][0].obuf);
+}
+
+static struct sox_flow_state * start_flow(sox_effects_chain_t * chain)
+{
+  struct sox_flow_state * s = new_flow_state(chain);
+  size_t e;
 
-  e = chain->length - 1;
-  while (source_e < chain->length) {
+  alloc_obufs(chain);
+
+  /* Between consecutive per-channel effects, keep the audio planar so that
+   * it needn't be interleaved by one and deinterleaved again by the next */
+  for (e = 0; e + 1 < chain->length; ++e)
+    s->planar[e] = chain->effects[e][0].flows > 1 &&
+        chain->effects[e + 1][0].flows == chain->effects[e][0].flows;
+
+  chain->ibufc = s->ibufc;
+  chain->obufc = s->obufc;
+  s->e = chain->length - 1;
+  s->draining = sox_true;
+  return s;
+}
+
+static void stop_flow(sox_effects_chain_t * chain, struct sox_flow_state * s)
+{
+  chain->ibufc = chain->obufc = NULL;
+  free_obufs(chain);
+  delete_flow_state(s);
+}
+
+#define flow_done(chain, s) ((s)->source_e >= (chain)->length || (s)->stopped)
+
+/* Run one flow or drain of one effect, then choose the effect to visit next:
+ * downstream if it gave output, otherwise back upstream for more input */
+static void flow_step(sox_effects_chain_t * chain, struct sox_flow_state * s)
+{
+  size_t e = s->e;
 #define have_imin (e > 0 && e < chain->length && chain->effects[e - 1][0].oend - chain->effects[e - 1][0].obeg >= chain->effects[e][0].imin)
-    size_t osize = chain->effects[e][0].oend - chain->effects[e][0].obeg;
-    if (e == source_e && (draining || !have_imin)) {
-      if (drain_effect(chain, e) == SOX_EOF) {
-        ++source_e;
-        draining = sox_false;
-      }
-    } else if (have_imin && flow_effect(chain, e) == SOX_EOF) {
-      flow_status = SOX_EOF;
-      if (e == chain->length - 1)
-        break;
-      source_e = e;
-      draining = sox_true;
+  size_t osize = chain->effects[e][0].oend - chain->effects[e][0].obeg;
+
+  if (e == s->source_e && (s->draining || !have_imin)) {
+    if (drain_effect(chain, s, e) == SOX_EOF) {
+      ++s->source_e;
+      s->draining = sox_false;
+    }
+  } else if (have_imin && flow_effect(chain, s, e) == SOX_EOF) {
+    s->status = SOX_EOF;
+    if (e == chain->length - 1) {
+      s->stopped = sox_true;
+      return;
     }
-    if (e < chain->length && chain->effects[e][0].oend - chain->effects[e][0].obeg > osize) /* False for output */
+    s->source_e = e;
+    s->draining = sox_true;
+  }
+  if (e < chain->length && chain->effects[e][0].oend - chain->effects[e][0].obeg > osize) { /* False for output */
+    if (e + 1 < chain->length) /* Output of the last effect is for the client */
       ++e;
-    else if (e == source_e)
-      draining = sox_true;
-    else if ((int)--e < (int)source_e)
-      e = source_e;
+  }
+  else if (e == s->source_e)
+    s->draining = sox_true;
+  else if ((int)--e < (int)s->source_e)
+    e = s->source_e;
+  s->e = e;
+#undef have_imin
+}
+
+/* Flow data through the effects chain until an effect or callback gives EOF */
+int sox_flow_effects(sox_effects_chain_t * chain, int (* callback)(sox_bool all_done, void * client_data), void * client_data)
+{
+  struct sox_flow_state * s = start_flow(chain);
+  int flow_status;
+
+  while (!flow_done(chain, s)) {
+    flow_step(chain, s);
+    if (s->stopped)
+      break;
 
-    if (callback && callback(source_e == chain->length, client_data) != SOX_SUCCESS) {
-      flow_status = SOX_EOF; /* Client has requested to stop the flow. */
+    if (callback && callback(s->source_e == chain->length, client_data) != SOX_SUCCESS) {
+      s->status = SOX_EOF; /* Client has requested to stop the flow. */
       break;
     }
   }
 
-  for (f = 0; f < max_flows; ++f) {
-    free(chain->ibufc[f]);
-    free(chain->obufc[f]);
+  flow_status = s->status;
+  stop_flow(chain, s);
+  return flow_status;
+}
+
+/* Pull up to `frames' frames of output from the last effect in the chain
+ * (which, unlike with sox_flow_effects, should not be an output effect).
+ * The chain is advanced only as far as needed to produce them, so a
+ * playback callback can drive it directly with constant memory use.
+ * Returns the number of frames rendered; fewer than requested only when
+ * the chain has finished, after which sox_render_status gives the outcome.
+ * Buffers are allocated on the first call and freed with the chain. */
+size_t sox_render_effects(sox_effects_chain_t * chain, sox_sample_t * obuf, size_t frames)
+{
+  sox_effect_t * effp;
+  size_t len, done = 0;
+
+  if (!chain->length)
+    return 0;
+  if (!chain->flow)
+    chain->flow = start_flow(chain);
+  effp = &chain->effects[chain->length - 1][0];
+  len = frames * effp->out_signal.channels;
+
+  while (done < len) {
+    size_t n = min(len - done, effp->oend - effp->obeg);
+
+    if (n) {
+      if (effp->flow_float)
+        float_to_samples(obuf + done, &effp->obuf[effp->obeg], n, &effp->clips);
+      else memcpy(obuf + done, &effp->obuf[effp->obeg], n * sizeof(*obuf));
+      done += n;
+      if ((effp->obeg += n) == effp->oend)
+        effp->obeg = effp->oend = 0;
+    }
+    else if (flow_done(chain, chain->flow))
+      break;
+    else flow_step(chain, chain->flow);
   }
-  free(chain->obufc);
-  free(chain->ibufc);
+  return done / effp->out_signal.channels;
+}
 
-  for (e = 0; e < chain->length; ++e)
-    free(chain->effects[e][0].obuf);
+int sox_render_status(sox_effects_chain_t * chain)
+{
+  return chain->flow? chain->flow->status : SOX_SUCCESS;
+}
+
+#ifdef HAVE_PTHREAD_H
+
+#include <pthread.h>
+
+/* One stage of a pipelined flow: an effect running on its own thread, fed
+ * from the previous stage's ring and feeding the next stage's ring */
+typedef struct {
+  sox_effects_chain_t * chain;
+  size_t n;                     /* Index of the effect */
+  sox_ring_t * iring, * oring;  /* NULL for the first and last stages */
+  sox_effect_t input;           /* Stands in for the previous effect */
+  struct sox_flow_state * s;
+  int (* callback)(sox_bool all_done, void * client_data);
+  void * client_data;
+  pthread_mutex_t * lock;       /* Held by the first stage while it reads its
+                                 * input and by the last around the callback */
+  pthread_t thread;
+  sox_bool started;
+} stage_t;
+
+/* Top up the stand-in input buffer, in whole frames, from the ring.  Returns
+ * sox_false at the end of the input. */
+static sox_bool stage_read(stage_t * st, sox_bool wait)
+{
+  sox_effect_t * in = &st->input;
+  size_t frame = in->out_signal.channels * sizeof(*in->obuf), space, n, m;
+  char * buf;
+
+  if (in->obeg) {
+    memmove(in->obuf, &in->obuf[in->obeg], (in->oend - in->obeg) * sizeof(*in->obuf));
+    in->oend -= in->obeg;
+    in->obeg = 0;
+  }
+  space = (sox_globals.bufsiz - in->oend) * sizeof(*in->obuf) / frame * frame;
+  if (!space || (!wait && !sox_ring_fill(st->iring)))
+    return sox_true;
+  buf = (char *)&in->obuf[in->oend];
+  if (!(n = sox_ring_read(st->iring, buf, space)))
+    return sox_false;
+  for (; n % frame; n += m)   /* The rest of the frame is on its way */
+    if (!(m = sox_ring_read(st->iring, buf + n, frame - n % frame)))
+      break;
+  in->oend += n / sizeof(*in->obuf);
+  return sox_true;
+}
+
+/* Pass this stage's output on; returns sox_false if the next stage has gone */
+static sox_bool stage_write(stage_t * st)
+{
+  sox_effect_t * effp = &st->chain->effects[st->n][0];
+  size_t len = (effp->oend - effp->obeg) * sizeof(*effp->obuf);
+  sox_bool ok = !st->oring ||
+    lsx_ring_write(st->oring, &effp->obuf[effp->obeg], len) == len;
+
+  effp->obeg = effp->oend = 0;
+  return ok;
+}
+
+static int stage_callback(stage_t * st, sox_bool all_done)
+{
+  int status;
 
+  pthread_mutex_lock(st->lock);
+  status = st->callback(all_done, st->client_data);
+  pthread_mutex_unlock(st->lock);
+  return status;
+}
+
+/* As flow_step, but for one effect with its input arriving through a ring:
+ * flow while there is input, then drain */
+static void * run_stage(void * arg)
+{
+  stage_t * st = arg;
+  sox_effect_t * effp = &st->chain->effects[st->n][0];
+  sox_bool more = st->iring != NULL, stopped = sox_false, progress = sox_true;
+
+  while (more || st->input.oend - st->input.obeg >= max(effp->imin, 1)) {
+    size_t have = st->input.oend - st->input.obeg, odone = effp->oend;
+
+    if (more && !progress &&
+        sox_globals.bufsiz - have < st->input.out_signal.channels)
+      break; /* With its input full the effect has stopped taking any, so it
+              * never will: rather than spin, read no more and drain it */
+    if (more)
+      more = stage_read(st, !progress || have < max(effp->imin, 1));
+    have = st->input.oend - st->input.obeg;
+    if (have < max(effp->imin, 1))
+      continue;
+    if (flow_effect(st->chain, st->s, st->n) == SOX_EOF) {
+      st->s->status = SOX_EOF;
+      stopped = st->n == st->chain->length - 1;
+      break;
+    }
+    progress = effp->oend != odone || st->input.oend - st->input.obeg != have;
+    if (!stage_write(st)) {
+      stopped = sox_true;
+      break;
+    }
+    if (st->callback && stage_callback(st, sox_false) != SOX_SUCCESS) {
+      st->s->status = SOX_EOF; /* Client has requested to stop the flow. */
+      stopped = sox_true;
+      break;
+    }
+    if (!more && !progress)
+      break;
+  }
+  if (more)
+    sox_ring_abort(st->iring); /* Nothing more will be read */
+
+  if (!stopped) {
+    int status;
+    do {
+      if (st->lock)
+        pthread_mutex_lock(st->lock);
+      status = drain_effect(st->chain, st->s, st->n);
+      if (st->lock)
+        pthread_mutex_unlock(st->lock);
+    } while (stage_write(st) && status != SOX_EOF);
+    if (st->callback && stage_callback(st, sox_true) != SOX_SUCCESS)
+      st->s->status = SOX_EOF;
+  }
+  if (st->oring)
+    lsx_ring_close(st->oring);
+  return NULL;
+}
+
+/* As sox_flow_effects, but with each effect running on its own thread,
+ * linked to its neighbours by bounded rings, so that decoding, effects and
+ * encoding proceed in parallel.  The last effect, and the callback, run on
+ * the calling thread; the first effect does not read while the callback
+ * runs, so the callback may seek the input.  The output is identical to that
+ * of sox_flow_effects. */
+int sox_pipeline_effects(sox_effects_chain_t * chain, int (* callback)(sox_bool all_done, void * client_data), void * client_data)
+{
+  size_t n, i, length = chain->length;
+  stage_t * stages;
+  pthread_mutex_t lock;
+  int flow_status = SOX_SUCCESS;
+
+  if (length < 2)
+    return sox_flow_effects(chain, callback, client_data);
+
+  alloc_obufs(chain);
+  stages = lsx_calloc(length, sizeof(*stages));
+  for (n = 0; n < length; ++n) {
+    stage_t * st = &stages[n];
+
+    st->chain = chain;
+    st->n = n;
+    st->s = new_flow_state(chain);
+    if (n + 1 < length)
+      st->oring = sox_ring_create(4 * sox_globals.bufsiz * sizeof(sox_sample_t));
+    if (n) {
+      st->iring = stages[n - 1].oring;
+      st->input = chain->effects[n - 1][0];
+      st->input.obuf = lsx_malloc(sox_globals.bufsiz * sizeof(*st->input.obuf));
+      st->input.obeg = st->input.oend = st->input.clips = 0;
+      st->s->input = &st->input;
+    }
+  }
+  pthread_mutex_init(&lock, NULL);
+  stages[0].lock = stages[length - 1].lock = &lock;
+  stages[length - 1].callback = callback;
+  stages[length - 1].client_data = client_data;
+
+  for (n = 0; n + 1 < length; ++n) {
+    if (pthread_create(&stages[n].thread, NULL, run_stage, &stages[n])) {
+      sox_effect_t * effp = &chain->effects[n][0];
+      lsx_fail("cannot create thread");
+      flow_status = SOX_EOF;
+      for (i = 0; i + 1 < length; ++i) { /* Make any running stages give up */
+        sox_ring_abort(stages[i].oring);
+        lsx_ring_close(stages[i].oring);
+      }
+      break;
+    }
+    stages[n].started = sox_true;
+  }
+  if (flow_status == SOX_SUCCESS)
+    run_stage(&stages[length - 1]);
+
+  for (n = 0; n < length; ++n) {
+    stage_t * st = &stages[n];
+
+    if (st->started)
+      pthread_join(st->thread, NULL);
+    if (st->s->status != SOX_SUCCESS)
+      flow_status = SOX_EOF;
+    if (n)
+      chain->effects[n - 1][0].clips += st->input.clips;
+    free(st->input.obuf);
+    delete_flow_state(st->s);
+  }
+  for (n = 0; n + 1 < length; ++n)
+    sox_ring_delete(stages[n].oring);
+  pthread_mutex_destroy(&lock);
+  free(stages);
+  free_obufs(chain);
   return flow_status;
 }
 
+#else
+
+int sox_pipeline_effects(sox_effects_chain_t * chain, int (* callback)(sox_bool all_done, void * client_data), void * client_data)
+{
+  return sox_flow_effects(chain, callback, client_data);
+}
+
+#endif
+
 size_t sox_effects_clips(sox_effects_chain_t * chain)
 {
   unsigned i, f;
@@ -391,6 +919,45 @@ size_t sox_effects_clips(sox_effects_chain_t * chain)
   return clips;
 }
 
+int sox_effects_set_param(sox_effects_chain_t * chain, char const * effect,
+    char const * name, double value)
+{
+  sox_effect_t * rate[SOX_MAX_EFFECTS];
+  double speed[SOX_MAX_EFFECTS], dummy;
+  unsigned i, j;
+  int result = SOX_EOF;
+
+  /* Check the change with every effect it concerns before making any */
+  for (i = 0; i < chain->length; ++i) {
+    sox_effect_t * effp = chain->effects[i];
+
+    rate[i] = NULL, speed[i] = 0;
+    if (strcmp(effp->handler.name, effect))
+      continue;
+    if (!effp->set_param || effp->set_param(effp, name, value, &speed[i]) != SOX_SUCCESS)
+      return SOX_EINVAL;
+    if (speed[i]) {   /* Find the effect that is to resample the output */
+      for (j = i + 1; j < chain->length && !rate[i]; ++j)
+        if (chain->effects[j]->set_param && chain->effects[j]->set_param(
+              chain->effects[j], "speed", speed[i], &dummy) == SOX_SUCCESS)
+          rate[i] = chain->effects[j];
+      if (!rate[i])
+        return SOX_EINVAL;
+    }
+    result = SOX_SUCCESS;
+  }
+  for (i = 0; result == SOX_SUCCESS && i < chain->length; ++i) {
+    sox_effect_t * effp = chain->effects[i];
+
+    if (strcmp(effp->handler.name, effect))
+      continue;
+    if (rate[i])
+      rate[i]->set_param(rate[i], "speed", speed[i], NULL);
+    effp->set_param(effp, name, value, NULL);
+  }
+  return result;
+}
+
 size_t sox_stop_effect(sox_effect_t *effp)
 {
   unsigned f;
@@ -360,11 +360,13 @@ FILE * lsx_open_input_file(sox_effect_t * effp, char const * filename)
 int lsx_effects_init(void)
 {
   init_fft_cache();
+  init_filter_cache();
   return SOX_SUCCESS;
 }
 
 int lsx_effects_quit(void)
 {
+  clear_filter_cache();
   clear_fft_cache();
   return SOX_SUCCESS;
 }
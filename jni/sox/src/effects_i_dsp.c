@@ -97,31 +97,60 @@ int lsx_set_dft_length(int num_taps) /* Set to 4 x nearest power of 2 */
 }
 
 #include "fft4g.h"
-static int * lsx_fft_br;
-static double * lsx_fft_sc;
-static int fft_len = -1;
-#ifdef HAVE_OPENMP
-static omp_lock_t fft_cache_lock;
+
+/* Each power-of-2 transform length has its own bit-reverse & twiddle tables
+ * (a `plan').  A plan is built completely the first time its length is used,
+ * then published and never modified or moved, so any number of threads can
+ * run transforms concurrently without locking; the lock below is taken only
+ * while building a plan. */
+typedef struct {
+  int    * br;
+  double * sc;
+} fft_plan_t;
+
+#define MAX_FFT_LOG2 30
+static fft_plan_t * volatile fft_plans[MAX_FFT_LOG2 + 1];
+static sox_bool fft_cache_ready;
+#if defined HAVE_PTHREAD_H
+  #include <pthread.h>
+  static pthread_mutex_t fft_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+  #define fft_cache_set_lock()   pthread_mutex_lock(&fft_cache_lock)
+  #define fft_cache_unset_lock() pthread_mutex_unlock(&fft_cache_lock)
+#else
+  static omp_lock_t fft_cache_lock;
+  #define fft_cache_set_lock()   omp_set_lock(&fft_cache_lock)
+  #define fft_cache_unset_lock() omp_unset_lock(&fft_cache_lock)
+#endif
+#if defined __GNUC__
+  #define fft_cache_barrier() __sync_synchronize()
+#else
+  #define fft_cache_barrier() (void)0
 #endif
 
 void init_fft_cache(void)
 {
-  assert(lsx_fft_br == NULL);
-  assert(lsx_fft_sc == NULL);
-  assert(fft_len == -1);
+  assert(!fft_cache_ready);
+#if !defined HAVE_PTHREAD_H
   omp_init_lock(&fft_cache_lock);
-  fft_len = 0;
+#endif
+  fft_cache_ready = sox_true;
 }
 
 void clear_fft_cache(void)
 {
-  assert(fft_len >= 0);
+  int i;
+
+  assert(fft_cache_ready);
+#if !defined HAVE_PTHREAD_H
   omp_destroy_lock(&fft_cache_lock);
-  free(lsx_fft_br);
-  free(lsx_fft_sc);
-  lsx_fft_sc = NULL;
-  lsx_fft_br = NULL;
-  fft_len = -1;
+#endif
+  for (i = 0; i <= MAX_FFT_LOG2; ++i) if (fft_plans[i]) {
+    free(fft_plans[i]->br);
+    free(fft_plans[i]->sc);
+    free(fft_plans[i]);
+    fft_plans[i] = NULL;
+  }
+  fft_cache_ready = sox_false;
 }
 
 static sox_bool is_power_of_2(int x)
@@ -129,33 +158,134 @@ static sox_bool is_power_of_2(int x)
   return !(x < 2 || (x & (x - 1)));
 }
 
-static void update_fft_cache(int len)
+static fft_plan_t const * fft_plan(int len)
 {
+  fft_plan_t * plan;
+  int log2_len = 0;
+
   assert(is_power_of_2(len));
-  assert(fft_len >= 0);
-  omp_set_lock(&fft_cache_lock);
-  if (len > fft_len) {
-    int old_n = fft_len;
-    fft_len = len;
-    lsx_fft_br = lsx_realloc(lsx_fft_br, dft_br_len(fft_len) * sizeof(*lsx_fft_br));
-    lsx_fft_sc = lsx_realloc(lsx_fft_sc, dft_sc_len(fft_len) * sizeof(*lsx_fft_sc));
-    if (!old_n)
-      lsx_fft_br[0] = 0;
+  assert(fft_cache_ready);
+  while ((1 << log2_len) < len)
+    ++log2_len;
+  if ((plan = fft_plans[log2_len]) != NULL)
+    return plan;
+
+  fft_cache_set_lock();
+  if ((plan = fft_plans[log2_len]) == NULL) {
+    double * tmp = lsx_calloc(len, sizeof(*tmp));
+
+    plan = lsx_malloc(sizeof(*plan));
+    plan->br = lsx_calloc(dft_br_len(len), sizeof(*plan->br));
+    plan->sc = lsx_calloc(dft_sc_len(len), sizeof(*plan->sc));
+    lsx_rdft(len, 1, tmp, plan->br, plan->sc); /* Fills both tables */
+    free(tmp);
+    fft_cache_barrier(); /* Tables must be complete before they are shared */
+    fft_plans[log2_len] = plan;
   }
+  fft_cache_unset_lock();
+  return plan;
 }
 
 void lsx_safe_rdft(int len, int type, double * d)
 {
-  update_fft_cache(len);
-  lsx_rdft(len, type, d, lsx_fft_br, lsx_fft_sc);
-  omp_unset_lock(&fft_cache_lock);
+  fft_plan_t const * plan = fft_plan(len);
+  lsx_rdft(len, type, d, plan->br, plan->sc);
 }
 
 void lsx_safe_cdft(int len, int type, double * d)
 {
-  update_fft_cache(len);
-  lsx_cdft(len, type, d, lsx_fft_br, lsx_fft_sc);
-  omp_unset_lock(&fft_cache_lock);
+  fft_plan_t const * plan = fft_plan(len);
+  lsx_cdft(len, type, d, plan->br, plan->sc);
+}
+
+/* A forward real DFT of any even length n, packed as by lsx_safe_rdft.  The
+ * n real samples are taken as n/2 complex ones, whose DFT is found by
+ * Bluestein's algorithm: a convolution with a `chirp', done by power-of-2
+ * DFTs of length m >= n - 1; the real spectrum is then unpacked from it.
+ * Power-of-2 lengths are passed straight to lsx_safe_rdft. */
+struct lsx_rdft_plan {
+  int    len, m;
+  double * chirp;      /* exp(-i pi k^2 / (n/2)), k < n/2 */
+  double * twiddle;    /* exp(-2 i pi k / n), k <= n/2 */
+  double * conv;       /* DFT of the conjugate chirp, scaled by 1/m */
+};
+
+lsx_rdft_plan_t * lsx_rdft_plan(int len)
+{
+  int i, h = len >> 1, m = 0;
+  lsx_rdft_plan_t * p;
+
+  assert(len >= 2 && !(len & 1));
+  if (!is_power_of_2(len))
+    for (m = 2; m < len - 1; m <<= 1);
+  p = lsx_calloc(1, sizeof(*p) + (2 * h + 2 * (h + 1) + 2 * m) * sizeof(double));
+  p->len = len, p->m = m;
+  p->chirp = (double *)(p + 1);
+  p->twiddle = p->chirp + 2 * h;
+  p->conv = p->twiddle + 2 * (h + 1);
+  if (!m)
+    return p;
+  for (i = 0; i < h; ++i) {      /* i^2 mod 2h keeps the angle accurate */
+    double x = M_PI * (double)((uint64_t)i * i % (uint64_t)(2 * h)) / h;
+    p->chirp[2 * i] = cos(x), p->chirp[2 * i + 1] = -sin(x);
+  }
+  for (i = 0; i <= h; ++i) {
+    double x = 2 * M_PI * i / len;
+    p->twiddle[2 * i] = cos(x), p->twiddle[2 * i + 1] = -sin(x);
+  }
+  for (i = 0; i < h; ++i) {
+    p->conv[2 * i] = p->chirp[2 * i] / m;
+    p->conv[2 * i + 1] = -p->chirp[2 * i + 1] / m;
+    if (i) {
+      p->conv[2 * (m - i)] = p->conv[2 * i];
+      p->conv[2 * (m - i) + 1] = p->conv[2 * i + 1];
+    }
+  }
+  lsx_safe_cdft(2 * m, 1, p->conv);
+  return p;
+}
+
+/* The number of doubles of work space needed by lsx_rdft_any */
+int lsx_rdft_work_len(lsx_rdft_plan_t const * p)
+{
+  return 2 * p->m;
+}
+
+void lsx_rdft_any(lsx_rdft_plan_t const * p, double * d, double * work)
+{
+  int i, h = p->len >> 1, m = p->m;
+  double const * c = p->chirp, * t = p->twiddle, * b = p->conv;
+
+  if (!m) {
+    lsx_safe_rdft(p->len, 1, d);
+    return;
+  }
+  for (i = 0; i < 2 * h; i += 2) {
+    work[i    ] = d[i] * c[i] - d[i + 1] * c[i + 1];
+    work[i + 1] = d[i] * c[i + 1] + d[i + 1] * c[i];
+  }
+  memset(work + 2 * h, 0, (2 * m - 2 * h) * sizeof(*work));
+  lsx_safe_cdft(2 * m, 1, work);
+  for (i = 0; i < 2 * m; i += 2) {
+    double tmp = work[i];
+    work[i    ] = tmp * b[i] - work[i + 1] * b[i + 1];
+    work[i + 1] = tmp * b[i + 1] + work[i + 1] * b[i];
+  }
+  lsx_safe_cdft(2 * m, -1, work);
+  for (i = 0; i < 2 * h; i += 2) {          /* The complex DFT, Z */
+    double tmp = work[i];
+    work[i    ] = tmp * c[i] - work[i + 1] * c[i + 1];
+    work[i + 1] = tmp * c[i + 1] + work[i + 1] * c[i];
+  }
+  d[0] = work[0] + work[1];
+  d[1] = work[0] - work[1];
+  for (i = 1; i < h; ++i) {                 /* X[i] from Z[i] & Z[h-i] */
+    double const * z = work + 2 * i, * y = work + 2 * (h - i);
+    double er = .5 * (z[0] + y[0]), ei = .5 * (z[1] - y[1]);
+    double or = .5 * (z[1] + y[1]), oi = -.5 * (z[0] - y[0]);
+    d[2 * i    ] = er + t[2 * i] * or - t[2 * i + 1] * oi;
+    d[2 * i + 1] = -(ei + t[2 * i] * oi + t[2 * i + 1] * or);
+  }
 }
 
 void lsx_power_spectrum(int n, double const * in, double * out)
@@ -0,0 +1,94 @@
+/* Simple example of using SoX libraries
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifdef NDEBUG /* N.B. assert used with active statements so enable always. */
+#undef NDEBUG /* Must undef above assert.h or other that might include it. */
+#endif
+
+#include "sox.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+
+#define BLOCK_FRAMES 256 /* As an audio callback might ask for */
+
+/*
+ * Reads input file, applies vol & flanger effects, and pulls the result
+ * from the chain a block at a time (as an audio device callback would)
+ * before storing it in the output file.
+ * E.g. example6 monkey.au monkey.aiff
+ */
+int main(int argc, char * argv[])
+{
+  static sox_format_t * in, * out; /* input and output files */
+  sox_effects_chain_t * chain;
+  sox_effect_t * e;
+  sox_signalinfo_t signal;
+  sox_sample_t * block;
+  size_t frames;
+  char * args[10];
+
+  assert(argc == 3);
+
+  /* All libSoX applications must start by initialising the SoX library */
+  assert(sox_init() == SOX_SUCCESS);
+
+  /* Open the input file (with default parameters) */
+  assert(in = sox_open_read(argv[1], NULL, NULL, NULL));
+
+  /* Open the output file; we must specify the output signal characteristics.
+   * Since we are using only simple effects, they are the same as the input
+   * file characteristics */
+  assert(out = sox_open_write(argv[2], &in->signal, NULL, NULL, NULL, NULL));
+
+  /* Create an effects chain; some effects need to know about the input
+   * or output file encoding so we provide that information here */
+  chain = sox_create_effects_chain(&in->encoding, &out->encoding);
+
+  /* The first effect in the effect chain must be something that can source
+   * samples; in this case, we use the built-in handler that inputs
+   * data from an audio file */
+  signal = in->signal;
+  e = sox_create_effect(sox_find_effect("input"));
+  args[0] = (char *)in, assert(sox_effect_options(e, 1, args) == SOX_SUCCESS);
+  assert(sox_add_effect(chain, e, &signal, &in->signal) == SOX_SUCCESS);
+
+  e = sox_create_effect(sox_find_effect("vol"));
+  args[0] = "3dB", assert(sox_effect_options(e, 1, args) == SOX_SUCCESS);
+  assert(sox_add_effect(chain, e, &signal, &in->signal) == SOX_SUCCESS);
+
+  e = sox_create_effect(sox_find_effect("flanger"));
+  assert(sox_effect_options(e, 0, NULL) == SOX_SUCCESS);
+  assert(sox_add_effect(chain, e, &signal, &in->signal) == SOX_SUCCESS);
+
+  /* There is no output effect: the application takes the samples from the
+   * end of the chain itself, as and when it wants them */
+  block = malloc(BLOCK_FRAMES * signal.channels * sizeof(*block));
+  do {
+    frames = sox_render_effects(chain, block, BLOCK_FRAMES);
+    assert(sox_write(out, block, frames * signal.channels) == frames * signal.channels);
+  } while (frames == BLOCK_FRAMES);
+  assert(sox_render_status(chain) == SOX_SUCCESS);
+
+  /* All done; tidy up: */
+  free(block);
+  sox_delete_effects_chain(chain);
+  sox_close(out);
+  sox_close(in);
+  sox_quit();
+  return 0;
+}
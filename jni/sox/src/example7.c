@@ -0,0 +1,101 @@
+/* Simple example of using SoX libraries
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifdef NDEBUG /* N.B. assert used with active statements so enable always. */
+#undef NDEBUG /* Must undef above assert.h or other that might include it. */
+#endif
+
+#include "sox.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <assert.h>
+
+#define BLOCK_FRAMES 256 /* As an audio callback might ask for */
+
+/* Adds the named effect, with the given options, to the end of the chain */
+static void add(sox_effects_chain_t * chain, sox_signalinfo_t * signal,
+    sox_signalinfo_t const * out_signal, char const * name, char * option)
+{
+  sox_effect_t * e = sox_create_effect(sox_find_effect(name));
+
+  assert(sox_effect_options(e, option? 1 : 0, &option) == SOX_SUCCESS);
+  assert(sox_add_effect(chain, e, signal, out_signal) == SOX_SUCCESS);
+  free(e);
+}
+
+/*
+ * Reads input file and pulls it through tempo, speed, rate & vol effects a
+ * block at a time (as an audio device callback would), storing the result
+ * in the output file.  Between blocks, the tempo and the speed swing either
+ * side of 1, and the volume is ducked every other 2 seconds, all without
+ * restarting the chain.
+ * E.g. example7 monkey.au monkey.aiff
+ */
+int main(int argc, char * argv[])
+{
+  static sox_format_t * in, * out; /* input and output files */
+  sox_effects_chain_t * chain;
+  sox_effect_t * e;
+  sox_signalinfo_t signal;
+  sox_sample_t * block;
+  size_t frames, done = 0;
+  char * args[10];
+
+  assert(argc == 3);
+  assert(sox_init() == SOX_SUCCESS);
+  assert(in = sox_open_read(argv[1], NULL, NULL, NULL));
+  assert(out = sox_open_write(argv[2], &in->signal, NULL, NULL, NULL, NULL));
+
+  /* Effects added to an adjustable chain stay in it even when they start
+   * off having no effect, ready to be changed */
+  chain = sox_create_effects_chain(&in->encoding, &out->encoding);
+  chain->adjustable = sox_true;
+
+  signal = in->signal;
+  e = sox_create_effect(sox_find_effect("input"));
+  args[0] = (char *)in, assert(sox_effect_options(e, 1, args) == SOX_SUCCESS);
+  assert(sox_add_effect(chain, e, &signal, &in->signal) == SOX_SUCCESS);
+  free(e);
+
+  add(chain, &signal, &in->signal, "tempo", "1");
+  add(chain, &signal, &in->signal, "speed", "1");
+  add(chain, &signal, &in->signal, "rate", NULL); /* Does the speed change */
+  add(chain, &signal, &in->signal, "vol", "1");
+
+  block = malloc(BLOCK_FRAMES * signal.channels * sizeof(*block));
+  do {
+    double t = done / signal.rate;  /* Output time */
+
+    /* E.g. from a UI thread; the effects take the changes up smoothly */
+    assert(sox_effects_set_param(chain, "tempo", "factor", 1 + .3 * sin(t)) == SOX_SUCCESS);
+    assert(sox_effects_set_param(chain, "speed", "factor", 1 + .2 * sin(t / 3)) == SOX_SUCCESS);
+    assert(sox_effects_set_param(chain, "vol", "gain", (int)t & 2? .5 : 1) == SOX_SUCCESS);
+
+    frames = sox_render_effects(chain, block, BLOCK_FRAMES);
+    assert(sox_write(out, block, frames * signal.channels) == frames * signal.channels);
+    done += frames;
+  } while (frames == BLOCK_FRAMES);
+  assert(sox_render_status(chain) == SOX_SUCCESS);
+
+  free(block);
+  sox_delete_effects_chain(chain);
+  sox_close(out);
+  sox_close(in);
+  sox_quit();
+  return 0;
+}
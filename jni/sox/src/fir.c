@@ -17,6 +17,7 @@
 
 #include "sox_i.h"
 #include "dft_filter.h"
+#include <string.h>
 
 typedef struct {
   dft_filter_priv_t  base;
@@ -65,11 +66,25 @@ static int start(sox_effect_t * effp)
       }
       if (file != stdin) fclose(file);
     }
-    lsx_set_dft_filter(f, p->h, p->n, p->n >> 1);
+    /* The coefs themselves are the key */
+    if (!lsx_find_filter(f, "fir", p->h, p->n)) {
+      double * h = lsx_malloc(p->n * sizeof(*h));
+      memcpy(h, p->h, p->n * sizeof(*h));
+      lsx_set_dft_filter(f, h, p->n, p->n >> 1);
+      lsx_cache_filter(f, "fir", p->h, p->n, (size_t)f->dft_length);
+    }
   }
   return lsx_dft_filter_effect_fn()->start(effp);
 }
 
+static int kill(sox_effect_t * effp)
+{
+  priv_t * p = (priv_t *)effp->priv;
+
+  free(p->h);
+  return SOX_SUCCESS;
+}
+
 sox_effect_handler_t const * lsx_fir_effect_fn(void)
 {
   static sox_effect_handler_t handler;
@@ -78,6 +93,7 @@ sox_effect_handler_t const * lsx_fir_effect_fn(void)
   handler.usage = "[coef-file|coefs]";
   handler.getopts = create;
   handler.start = start;
+  handler.kill = kill;
   handler.priv_size = sizeof(priv_t);
   return &handler;
 }
@@ -47,10 +47,11 @@ typedef struct {
   unsigned sample_rate;
   unsigned total_samples;
 
-  /* Decode buffer: */
-  FLAC__int32 const * const * decoded_wide_samples;
-  unsigned number_of_wide_samples;
-  unsigned wide_sample_number;
+  /* Decode buffer: the last frame decoded, interleaved */
+  sox_sample_t * pcm;
+  size_t pcm_size;    /* # samples allocated */
+  size_t pcm_len;     /* # samples in the frame */
+  size_t pcm_pos;     /* # samples read from it */
 
   FLAC__StreamDecoder * decoder;
   FLAC__bool eof;
@@ -122,10 +123,13 @@ static FLAC__StreamDecoderWriteStatus FLAC__frame_decode_callback(FLAC__StreamDe
     return FLAC__STREAM_DECODER_WRITE_STATUS_ABORT;
   }
 
-  /* FIXME: We're skating on thin ice here: buffer may be on the stack! */
-  p->decoded_wide_samples = buffer;
-  p->number_of_wide_samples = frame->header.blocksize;
-  p->wide_sample_number = 0;
+  /* buffer is valid only during this call, so the frame is converted now */
+  p->pcm_len = (size_t)frame->header.blocksize * p->channels;
+  if (p->pcm_len > p->pcm_size)
+    p->pcm = lsx_realloc(p->pcm, (p->pcm_size = p->pcm_len) * sizeof(*p->pcm));
+  lsx_s32_planar_to_samples(p->pcm, (int32_t const * const *)buffer,
+      (size_t)frame->header.blocksize, p->channels, p->bits_per_sample);
+  p->pcm_pos = 0;
   return FLAC__STREAM_DECODER_WRITE_STATUS_CONTINUE;
 }
 
@@ -195,28 +199,22 @@ static size_t read_samples(sox_format_t * const ft, sox_sample_t * sampleBuffer,
 
   if (p->seek_pending) {
     p->seek_pending = sox_false; 
-    p->wide_sample_number = p->number_of_wide_samples = 0;
+    p->pcm_pos = p->pcm_len = 0;
     if (!FLAC__stream_decoder_seek_absolute(p->decoder, (FLAC__uint64)(p->seek_offset / ft->signal.channels)))
       return 0;
   }
   while (!p->eof && actual < requested) {
-    if (p->wide_sample_number >= p->number_of_wide_samples)
+    if (p->pcm_pos >= p->pcm_len) {
+      p->pcm_pos = p->pcm_len = 0;
       FLAC__stream_decoder_process_single(p->decoder);
-    if (p->wide_sample_number >= p->number_of_wide_samples)
+    }
+    if (p->pcm_pos >= p->pcm_len)
       p->eof = sox_true;
-    else { /* FIXME: this block should really be inside the decode callback */
-      unsigned channel;
-
-      for (channel = 0; channel < p->channels; channel++, actual++) {
-        FLAC__int32 d = p->decoded_wide_samples[channel][p->wide_sample_number];
-        switch (p->bits_per_sample) {
-        case  8: *sampleBuffer++ = SOX_SIGNED_8BIT_TO_SAMPLE(d,); break;
-        case 16: *sampleBuffer++ = SOX_SIGNED_16BIT_TO_SAMPLE(d,); break;
-        case 24: *sampleBuffer++ = SOX_SIGNED_24BIT_TO_SAMPLE(d,); break;
-        case 32: *sampleBuffer++ = SOX_SIGNED_32BIT_TO_SAMPLE(d,); break;
-        }
-      }
-      ++p->wide_sample_number;
+    else {
+      size_t n = min(requested - actual, p->pcm_len - p->pcm_pos);
+      memcpy(sampleBuffer + actual, p->pcm + p->pcm_pos, n * sizeof(*p->pcm));
+      p->pcm_pos += n;
+      actual += n;
     }
   }
   return actual;
@@ -230,6 +228,7 @@ static int stop_read(sox_format_t * const ft)
   if (!FLAC__stream_decoder_finish(p->decoder) && p->eof)
     lsx_warn("decoder MD5 checksum mismatch.");
   FLAC__stream_decoder_delete(p->decoder);
+  free(p->pcm);
   return SOX_SUCCESS;
 }
 
@@ -371,6 +370,11 @@ static int start_write(sox_format_t * const ft)
   }
 #endif
 
+  if (sox_globals.flac_threads > 1) {
+    lsx_report("encoding with %u threads", sox_globals.flac_threads);
+    FLAC__stream_encoder_set_num_threads(p->encoder, sox_globals.flac_threads);
+  }
+
   if (ft->signal.length != 0) {
     FLAC__stream_encoder_set_total_samples_estimate(p->encoder, (FLAC__uint64)(ft->signal.length / ft->signal.channels));
 
@@ -555,6 +555,8 @@ error:
   if (ft->fp && ft->fp != stdin)
     xfclose(ft->fp, ft->io_type);
   free(ft->priv);
+  free(ft->scratch[0]);
+  free(ft->scratch[1]);
   free(ft->filename);
   free(ft->filetype);
   free(ft);
@@ -916,6 +918,8 @@ error:
   if (ft->fp && ft->fp != stdout)
     xfclose(ft->fp, ft->io_type);
   free(ft->priv);
+  free(ft->scratch[0]);
+  free(ft->scratch[1]);
   free(ft->filename);
   free(ft->filetype);
   free(ft);
@@ -994,6 +998,8 @@ int sox_close(sox_format_t * ft)
   if (ft->fp && ft->fp != stdin && ft->fp != stdout)
     xfclose(ft->fp, ft->io_type);
   free(ft->priv);
+  free(ft->scratch[0]);
+  free(ft->scratch[1]);
   free(ft->filename);
   free(ft->filetype);
   sox_delete_comments(&ft->oob.comments);
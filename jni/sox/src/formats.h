@@ -97,6 +97,9 @@
 #if defined HAVE_OSS && (defined STATIC_OSS || !defined HAVE_LIBLTDL)
   FORMAT(oss)
 #endif
+#if defined HAVE_PTHREAD_H
+  FORMAT(ring)
+#endif
 #if defined HAVE_PULSEAUDIO && (defined STATIC_PULSEAUDIO || !defined HAVE_LIBLTDL)
   FORMAT(pulseaudio)
 #endif
@@ -102,6 +102,18 @@ size_t lsx_readbuf(sox_format_t * ft, void *buf, size_t len)
   return ret;
 }
 
+/* Get work area `which', of at least size bytes; its contents are not kept
+ * when it grows.  It is freed by sox_close. */
+void * lsx_scratch(sox_format_t * ft, lsx_scratch_t which, size_t size)
+{
+  if (size > ft->scratch_size[which]) {
+    free(ft->scratch[which]);
+    ft->scratch[which] = lsx_malloc(size);
+    ft->scratch_size[which] = size;
+  }
+  return ft->scratch[which];
+}
+
 /* Skip input without seeking. */
 int lsx_skipbytes(sox_format_t * ft, size_t n)
 {
@@ -364,11 +376,10 @@ static uint8_t const cswap[256] = {
       sox_format_t * ft, ctype *buf, size_t len) \
   { \
     size_t n, nread; \
-    uint8_t *data = lsx_malloc(size * len); \
+    uint8_t *data = lsx_scratch(ft, lsx_scratch_bytes, size * len); \
     nread = lsx_readbuf(ft, data, len * size) / size; \
     for (n = 0; n < nread; n++) \
       buf[n] = sox_unpack ## size(data + n * size); \
-    free(data); \
     return n; \
   }
 
@@ -435,11 +446,10 @@ int lsx_readchars(sox_format_t * ft, char * chars, size_t len)
       sox_format_t * ft, ctype *buf, size_t len) \
   { \
     size_t n, nwritten; \
-    uint8_t *data = lsx_malloc(size * len); \
+    uint8_t *data = lsx_scratch(ft, lsx_scratch_bytes, size * len); \
     for (n = 0; n < len; n++) \
       sox_pack ## size(data + n * size, buf[n]); \
     nwritten = lsx_writebuf(ft, data, len * size); \
-    free(data); \
     return nwritten / size; \
   }
 
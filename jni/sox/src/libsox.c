@@ -49,6 +49,11 @@ sox_globals_t sox_globals = {
   8192,            /* size_t       bufsiz */
   0,               /* size_t       input_bufsiz */
   0,               /* int32_t      ranqd1 */
+  16 << 20,        /* size_t       filter_cache_size */
+  0,               /* size_t       filter_block */
+  NULL,            /* char const * mp3_index_dir */
+  sox_false,       /* sox_bool     mp3_toc_seek */
+  0,               /* unsigned     flac_threads */
   NULL,            /* char const * stdin_in_use_by */
   NULL,            /* char const * stdout_in_use_by */
   NULL,            /* char const * subsystem */
@@ -98,11 +98,13 @@ static int start(sox_effect_t * effp)
 {
   priv_t * p = (priv_t *) effp->priv;
   dft_filter_t * f = p->base.filter_ptr;
+  double key[] = {p->n, p->start, p->delta, effp->in_signal.rate};
 
   if (p->delta == 0)
     return SOX_EFF_NULL;
 
-  if (!f->num_taps) {
+  if (!f->num_taps && (effp->global_info->plot != sox_plot_off ||
+        !lsx_find_filter(f, "loudness", key, (int)array_length(key)))) {
     double * h = make_filter(p->n, p->start, p->delta, effp->in_signal.rate);
     if (effp->global_info->plot != sox_plot_off) {
       char title[100];
@@ -112,6 +114,7 @@ static int start(sox_effect_t * effp)
       return SOX_EOF;
     }
     lsx_set_dft_filter(f, h, p->n, p->n >> 1);
+    lsx_cache_filter(f, "loudness", key, (int)array_length(key), (size_t)f->dft_length);
   }
   return lsx_dft_filter_effect_fn()->start(effp);
 }
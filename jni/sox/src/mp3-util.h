@@ -234,4 +234,165 @@ static size_t mp3_duration_ms(sox_format_t * ft)
   return p->mad_timer_count(time, MAD_UNITS_MILLISECONDS);
 }
 
+/* Reads the table of contents, if any, from a Xing/Info or VBRI header in
+ * the first frame (which starts at file offset pos), as points relating
+ * frame numbers to file offsets, for approximate seeking. */
+static void read_toc(priv_t * p, unsigned char const * frame, size_t len, uint64_t pos)
+{
+  struct mad_header const * h = &p->Frame.header;
+  unsigned char const * x = frame + 4 + (h->flags & MAD_FLAG_PROTECTION? 2 : 0);
+  size_t i;
+
+  #define BE16(b) (((unsigned)(b)[0] << 8) | (b)[1])
+  #define BE32(b) (((uint32_t)BE16(b) << 16) | BE16((b) + 2))
+  if (h->layer != MAD_LAYER_III)
+    return;
+  x += h->flags & MAD_FLAG_LSF_EXT? (h->mode? 17 : 9) : (h->mode? 32 : 17);
+  if (x + 120 <= frame + len && (!memcmp(x, "Xing", 4) || !memcmp(x, "Info", 4))
+      && (BE32(x + 4) & 7) == 7) {     /* Has frames, bytes & TOC */
+    uint32_t frames = BE32(x + 8), bytes = BE32(x + 12);
+    if (!frames || !bytes)
+      return;
+    p->toc = lsx_malloc(100 * sizeof(*p->toc));
+    for (p->toc_len = 0; p->toc_len < 100; ++p->toc_len) {
+      p->toc[p->toc_len].frame = (size_t)((uint64_t)frames * p->toc_len / 100);
+      p->toc[p->toc_len].pos = pos + (uint64_t)bytes * x[16 + p->toc_len] / 256;
+    }
+    lsx_debug("got Xing TOC (frames=%lu)", (unsigned long)frames);
+    return;
+  }
+  x = frame + 36;
+  if (x + 26 <= frame + len && !memcmp(x, "VBRI", 4)) {
+    unsigned entries = BE16(x + 18), scale = BE16(x + 20);
+    unsigned size = BE16(x + 22), per_entry = BE16(x + 24);
+    uint64_t at = pos + len;
+    uint32_t bytes;
+    if (!entries || !per_entry || size < 1 || size > 4 ||
+        x + 26 + (size_t)entries * size > frame + len)
+      return;
+    p->toc = lsx_malloc((entries + 1) * sizeof(*p->toc));
+    for (p->toc_len = 0, x += 26; ; x += size) {
+      p->toc[p->toc_len].frame = 1 + (size_t)per_entry * p->toc_len;
+      p->toc[p->toc_len].pos = at;
+      if (++p->toc_len > entries)
+        break;
+      for (i = 0, bytes = 0; i < size; ++i)
+        bytes = bytes << 8 | x[i];
+      at += (uint64_t)bytes * scale;
+    }
+    lsx_debug("got VBRI TOC (entries=%u)", entries);
+  }
+  #undef BE32
+  #undef BE16
+}
+
+/* Frame offsets recorded by the MP3 reader can be kept in a file, so that
+ * seeks in a large VBR file are quick the next time that it is opened.  The
+ * file is named from a hash of the MP3's path, size & modification time, and
+ * starts with this header; the offsets themselves follow. */
+typedef struct {
+  char     magic[8];
+  uint64_t size, mtime;
+  uint64_t frames;              /* # frames whose offsets are known */
+  uint32_t step;                /* MP3_INDEX_STEP */
+  uint32_t complete;            /* frames includes the last frame */
+} index_header_t;
+
+static char const index_magic[8] = "SoXmp3i1";
+
+static char * index_filename(sox_format_t * ft, struct stat const * st)
+{
+  char const * dir = sox_globals.mp3_index_dir;
+  uint64_t hash = 14695981039346656037u;  /* FNV-1a */
+  uint64_t key[2];
+  unsigned char const * c;
+  char * name;
+  size_t i;
+
+  if (!dir || !ft->seekable || !ft->filename)
+    return NULL;
+  if (!*dir) {                  /* Sidecar */
+    name = lsx_malloc(strlen(ft->filename) + 5);
+    sprintf(name, "%s.sxi", ft->filename);
+    return name;
+  }
+  key[0] = st->st_size, key[1] = st->st_mtime;
+  for (c = (unsigned char const *)ft->filename; *c; ++c)
+    hash = (hash ^ *c) * 1099511628211u;
+  for (c = (unsigned char const *)key, i = 0; i < sizeof(key); ++i)
+    hash = (hash ^ c[i]) * 1099511628211u;
+  name = lsx_malloc(strlen(dir) + 1 + 16 + 4 + 1);
+  sprintf(name, "%s/%08lx%08lx.sxi", dir,
+      (unsigned long)(hash >> 32), (unsigned long)(hash & 0xffffffff));
+  return name;
+}
+
+/* Loads a saved index, if there is one that matches the file & whose first
+ * frame is at offset0.  Returns whether one was loaded. */
+static sox_bool load_index(sox_format_t * ft, uint64_t offset0)
+{
+  priv_t * p = (priv_t *) ft->priv;
+  struct stat st;
+  index_header_t h;
+  char * name;
+  FILE * f = NULL;
+  size_t n;
+
+  if (fstat(fileno(ft->fp), &st) || !(name = index_filename(ft, &st)))
+    return sox_false;
+  if ((f = fopen(name, "rb")) && fread(&h, sizeof(h), 1, f) == 1 &&
+      !memcmp(h.magic, index_magic, sizeof(h.magic)) &&
+      h.size == (uint64_t)st.st_size && h.mtime == (uint64_t)st.st_mtime &&
+      h.step == MP3_INDEX_STEP && h.frames && h.frames < SOX_SIZE_MAX / 2) {
+    n = (size_t)(h.frames + MP3_INDEX_STEP - 1) / MP3_INDEX_STEP;
+    p->index = lsx_realloc(p->index, n * sizeof(*p->index));
+    if (fread(p->index, sizeof(*p->index), n, f) == n && p->index[0] == offset0) {
+      p->index_size = n;
+      p->index_frames = p->index_saved = h.frames;
+      p->index_complete = h.complete;
+      lsx_debug("loaded seek index `%s' (frames=%lu)", name, (unsigned long)h.frames);
+    }
+  }
+  if (f)
+    fclose(f);
+  free(name);
+  return p->index_frames != 0;
+}
+
+static void save_index(sox_format_t * ft)
+{
+  priv_t * p = (priv_t *) ft->priv;
+  struct stat st;
+  index_header_t h;
+  char * name, * tmp;
+  FILE * f;
+  size_t n = (p->index_frames + MP3_INDEX_STEP - 1) / MP3_INDEX_STEP;
+
+  if (p->index_frames <= p->index_saved ||
+      fstat(fileno(ft->fp), &st) || !(name = index_filename(ft, &st)))
+    return;
+  memset(&h, 0, sizeof(h));
+  memcpy(h.magic, index_magic, sizeof(h.magic));
+  h.size = st.st_size;
+  h.mtime = st.st_mtime;
+  h.frames = p->index_frames;
+  h.step = MP3_INDEX_STEP;
+  h.complete = p->index_complete;
+
+  /* Written in full under another name first, so readers never see part */
+  tmp = lsx_malloc(strlen(name) + 5);
+  sprintf(tmp, "%s.tmp", name);
+  if ((f = fopen(tmp, "wb"))) {
+    sox_bool ok = fwrite(&h, sizeof(h), 1, f) == 1 &&
+      fwrite(p->index, sizeof(*p->index), n, f) == n;
+    if (fclose(f) || !ok || rename(tmp, name)) {
+      lsx_warn("can't write seek index `%s'", name);
+      remove(tmp);
+    }
+    else lsx_debug("saved seek index `%s' (frames=%lu)", name, (unsigned long)h.frames);
+  }
+  free(tmp);
+  free(name);
+}
+
 #endif /* HAVE_MAD_H */
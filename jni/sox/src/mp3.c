@@ -199,6 +199,10 @@ static const char* const lame_library_names[] =
   LAME_FUNC_398_ID3(f,x, size_t, lame_get_id3v2_tag, (lame_global_flags *, unsigned char*, size_t)) \
   LAME_FUNC_398_ID3(f,x, int, id3tag_set_fieldvalue, (lame_global_flags *, const char *))
 
+/* A frame offset is indexed for every MP3_INDEX_STEP frames; seeks decode
+ * headers from there on to the frame sought */
+#define MP3_INDEX_STEP 16
+
 /* Private data */
 typedef struct mp3_priv_t {
   unsigned char *mp3_buffer;
@@ -211,6 +215,16 @@ typedef struct mp3_priv_t {
   mad_timer_t             Timer;
   ptrdiff_t               cursamp;
   size_t                  FrameCount;
+  uint64_t                buf_pos;        /* File offset of mp3_buffer[0] */
+  unsigned                spf;            /* Samples per frame */
+  uint64_t                * index;        /* Offsets of frames 0, STEP, 2STEP, ... */
+  size_t                  index_size;     /* # entries allocated */
+  size_t                  index_frames;   /* # frames (from 0) whose offsets are known */
+  size_t                  index_saved;    /* index_frames as last loaded or saved */
+  sox_bool                index_complete; /* index_frames is all the frames */
+  sox_bool                index_live;     /* FrameCount is exact, so can extend index */
+  struct {size_t frame; uint64_t pos;} * toc; /* From a Xing/VBRI header */
+  size_t                  toc_len;
   LSX_DLENTRIES_TO_PTRS(MAD_FUNC_ENTRIES, mad_dl);
 #endif /*HAVE_MAD_H*/
 
@@ -281,6 +295,7 @@ static int sox_mp3_input(sox_format_t * ft)
      * (448000*(1152/32000))/8
      */
     memmove(p->mp3_buffer, p->Stream.next_frame, remaining);
+    p->buf_pos += p->Stream.next_frame - p->mp3_buffer;
 
     bytes_read = lsx_readbuf(ft, p->mp3_buffer+remaining,
                             p->mp3_buffer_size-remaining);
@@ -334,6 +349,41 @@ static int sox_mp3_inputtag(sox_format_t * ft)
     return rc;
 }
 
+/* Notes the offset of frame n, now in the stream, if it is the next in the
+ * run of frames whose offsets are known. */
+static void index_frame(priv_t * p, size_t n)
+{
+  if (!p->index_live || n != p->index_frames)
+    return;
+  if (n % MP3_INDEX_STEP == 0) {
+    size_t i = n / MP3_INDEX_STEP;
+    if (i == p->index_size) {
+      p->index_size = max(64, 2 * i);
+      p->index = lsx_realloc(p->index, p->index_size * sizeof(*p->index));
+    }
+    p->index[i] = p->buf_pos + (p->Stream.this_frame - p->mp3_buffer);
+  }
+  ++p->index_frames;
+}
+
+/* Restarts the stream from file offset pos */
+static int sox_mp3_restart(sox_format_t * ft, uint64_t pos)
+{
+  priv_t *p = (priv_t *) ft->priv;
+  size_t bytes_read;
+
+  p->mad_stream_finish(&p->Stream);
+  p->mad_stream_init(&p->Stream);
+  if (lsx_seeki(ft, (off_t)pos, SEEK_SET) != SOX_SUCCESS)
+    return SOX_EOF;
+  p->buf_pos = pos;
+  bytes_read = lsx_readbuf(ft, p->mp3_buffer, p->mp3_buffer_size);
+  if (bytes_read == 0)
+    return SOX_EOF;
+  p->mad_stream_buffer(&p->Stream, p->mp3_buffer, bytes_read);
+  return SOX_SUCCESS;
+}
+
 static int startread(sox_format_t * ft)
 {
   priv_t *p = (priv_t *) ft->priv;
@@ -376,6 +426,7 @@ static int startread(sox_format_t * ft)
    * format.  The decoded frame will be saved off so that it
    * can be processed later.
    */
+  p->buf_pos = lsx_tell(ft);
   ReadSize = lsx_readbuf(ft, p->mp3_buffer, p->mp3_buffer_size);
   if (ReadSize != p->mp3_buffer_size && ferror(ft->fp))
     return SOX_EOF;
@@ -429,6 +480,15 @@ static int startread(sox_format_t * ft)
   }
 
   p->FrameCount=1;
+  p->spf = 32 * MAD_NSBSAMPLES(&p->Frame.header);
+  if (ft->seekable) {
+    uint64_t offset0 = p->buf_pos + (p->Stream.this_frame - p->mp3_buffer);
+    read_toc(p, p->Stream.this_frame,
+        (size_t)(p->Stream.next_frame - p->Stream.this_frame), offset0);
+    p->index_live = sox_true;
+    if (!load_index(ft, offset0))
+      index_frame(p, 0);
+  }
 
   p->mad_timer_add(&p->Timer,p->Frame.header.duration);
   p->mad_synth_frame(&p->Synth,&p->Frame);
@@ -486,6 +546,7 @@ static size_t sox_mp3read(sox_format_t * ft, sox_sample_t *buf, size_t len)
         {
             if (sox_mp3_input(ft) == SOX_EOF) {
                 lsx_debug("sox_mp3_input EOF");
+                p->index_complete |= p->index_live && p->FrameCount == p->index_frames;
                 break;
             }
         }
@@ -494,6 +555,9 @@ static size_t sox_mp3read(sox_format_t * ft, sox_sample_t *buf, size_t len)
         {
             if(MAD_RECOVERABLE(p->Stream.error))
             {
+                /* A bad frame is counted by seek, but not here */
+                if (p->Stream.error >= MAD_ERROR_BADCRC)
+                    p->index_live = sox_false;
                 sox_mp3_inputtag(ft);
                 continue;
             }
@@ -509,7 +573,7 @@ static size_t sox_mp3read(sox_format_t * ft, sox_sample_t *buf, size_t len)
                 }
             }
         }
-        p->FrameCount++;
+        index_frame(p, p->FrameCount++);
         p->mad_timer_add(&p->Timer,p->Frame.header.duration);
         p->mad_synth_frame(&p->Synth,&p->Frame);
         p->cursamp=0;
@@ -526,113 +590,106 @@ static int stopread(sox_format_t * ft)
   p->mad_frame_finish(&p->Frame);
   p->mad_stream_finish(&p->Stream);
 
+  save_index(ft);
+  free(p->index);
+  free(p->toc);
   free(p->mp3_buffer);
   LSX_DLLIBRARY_CLOSE(p, mad_dl);
   return SOX_SUCCESS;
 }
 
+/* Frames decoded in full before the one sought, to fill libmad's bit
+ * reservoir (Layer III frames may take data from those preceding them)
+ * and synthesis filter. */
+#define MP3_SEEK_PRIME 3
+
+/* Seeks via the index of frame offsets, extending it by decoding frame
+ * headers if the frame sought is beyond it.  If sox_globals.mp3_toc_seek is
+ * set, a Xing or VBRI table of contents is used instead of extending the
+ * index, which is quicker but not sample-accurate. */
 static int sox_mp3seek(sox_format_t * ft, uint64_t offset)
 {
   priv_t   * p = (priv_t *) ft->priv;
-  size_t   initial_bitrate = p->Frame.header.bitrate;
-  size_t   tagsize = 0, consumed = 0;
-  sox_bool vbr = sox_false; /* Variable Bit Rate */
-  sox_bool depadded = sox_false;
-  uint64_t to_skip_samples = 0;
-
-  /* Reset all */
-  rewind(ft->fp);
-  mad_timer_reset(&p->Timer);
-  p->FrameCount = 0;
+  struct mad_header header;
+  size_t   target, skip, start, n;
+  uint64_t pos;
+
+  if (!p->index_frames && !p->toc_len)
+    return SOX_EOF;
+  offset /= ft->signal.channels;
+  target = offset / p->spf;
+  skip = offset % p->spf;
+  start = target > MP3_SEEK_PRIME? target - MP3_SEEK_PRIME : 0;
+  if (p->index_complete && target >= p->index_frames) {
+    lsx_debug("seek failure. beyond last frame (frames=%lu)", (unsigned long)p->index_frames);
+    return SOX_EOF;
+  }
+
+  if (start >= p->index_frames && p->toc_len && sox_globals.mp3_toc_seek) {
+    size_t lo = 0, hi = p->toc_len;
+
+    while (hi - lo > 1) {
+      size_t mid = (lo + hi) / 2;
+      *(p->toc[mid].frame <= start? &lo : &hi) = mid;
+    }
+    pos = p->toc[lo].pos;
+    if (hi < p->toc_len && p->toc[hi].frame > p->toc[lo].frame)
+      pos += (p->toc[hi].pos - p->toc[lo].pos) * (start - p->toc[lo].frame) /
+        (p->toc[hi].frame - p->toc[lo].frame);
+    p->index_live = sox_false;
+    n = start;
+  }
+  else {
+    n = min(start, p->index_frames - 1) / MP3_INDEX_STEP;
+    pos = p->index[n];
+    p->index_live = sox_true;
+    n *= MP3_INDEX_STEP;
+  }
 
   /* They where opened in startread */
   mad_synth_finish(&p->Synth);
   p->mad_frame_finish(&p->Frame);
-  p->mad_stream_finish(&p->Stream);
-
-  p->mad_stream_init(&p->Stream);
   p->mad_frame_init(&p->Frame);
   p->mad_synth_init(&p->Synth);
+  p->mad_header_init(&header);
+  if (sox_mp3_restart(ft, pos) != SOX_SUCCESS)
+    return SOX_EOF;
 
-  offset /= ft->signal.channels;
-  to_skip_samples = offset;
-
-  while(sox_true) {  /* Read data from the MP3 file */
-    int read, padding = 0;
-    size_t leftover = p->Stream.bufend - p->Stream.next_frame;
+  while (sox_true) {
+    int error = n < start?
+      p->mad_header_decode(&header, &p->Stream) :
+      p->mad_frame_decode(&p->Frame, &p->Stream);
 
-    memcpy(p->mp3_buffer, p->Stream.this_frame, leftover);
-    read = fread(p->mp3_buffer + leftover, (size_t) 1, p->mp3_buffer_size - leftover, ft->fp);
-    if (read <= 0) {
-      lsx_debug("seek failure. unexpected EOF (frames=%lu leftover=%lu)", (unsigned long)p->FrameCount, (unsigned long)leftover);
-      break;
-    }
-    for (; !depadded && padding < read && !p->mp3_buffer[padding]; ++padding);
-    depadded = sox_true;
-    p->mad_stream_buffer(&p->Stream, p->mp3_buffer + padding, leftover + read - padding);
-
-    while (to_skip_samples >= 0) {  /* Decode frame headers */
-      static unsigned short samples;
-      p->Stream.error = MAD_ERROR_NONE;
-      
-      /* Not an audio frame */
-      if (p->mad_header_decode(&p->Frame.header, &p->Stream) == -1) {
-        if (p->Stream.error == MAD_ERROR_BUFLEN)
-          break;  /* Normal behaviour; get some more data from the file */
-        if (!MAD_RECOVERABLE(p->Stream.error)) {
-          lsx_warn("unrecoverable MAD error");
-          break;
-        }
-        if (p->Stream.error == MAD_ERROR_LOSTSYNC) {
-          unsigned available = (p->Stream.bufend - p->Stream.this_frame);
-          tagsize = tagtype(p->Stream.this_frame, (size_t) available);
-          if (tagsize) {   /* It's some ID3 tags, so just skip */
-            if (tagsize >= available) {
-              fseeko(ft->fp, (off_t)(tagsize - available), SEEK_CUR);
-              depadded = sox_false;
-            }
-            p->mad_stream_skip(&p->Stream, min(tagsize, available));
-          }
-          else lsx_warn("MAD lost sync");
+    if (error == -1 && p->Stream.error < MAD_ERROR_BADCRC) {
+      if (p->Stream.error == MAD_ERROR_BUFLEN) {
+        if (sox_mp3_input(ft) == SOX_EOF) {
+          lsx_debug("seek failure. unexpected EOF (frames=%lu)", (unsigned long)n);
+          p->index_complete |= p->index_live && n == p->index_frames;
+          return SOX_EOF;
         }
-        else lsx_warn("recoverable MAD error");
-        continue;
-      }
-
-      consumed += p->Stream.next_frame - p->Stream.this_frame;
-      vbr      |= (p->Frame.header.bitrate != initial_bitrate);
-
-      samples = 32 * MAD_NSBSAMPLES(&p->Frame.header);
-
-      p->FrameCount++;
-      p->mad_timer_add(&p->Timer, p->Frame.header.duration);
-
-      if(to_skip_samples <= samples)
-      {
-        p->mad_frame_decode(&p->Frame,&p->Stream);
-        p->mad_synth_frame(&p->Synth, &p->Frame);
-        p->cursamp = to_skip_samples;
-        return SOX_SUCCESS;
       }
-      else to_skip_samples -= samples;
-
-      /* If not VBR, we can extrapolate frame size */
-      if (p->FrameCount == 64 && !vbr) {
-        p->FrameCount = offset / samples;
-        to_skip_samples = offset % samples;
-
-        if (SOX_SUCCESS != lsx_seeki(ft, (p->FrameCount * consumed / 64) + tagsize, SEEK_SET))
-          return SOX_EOF;
-
-        /* Reset Stream for refilling buffer */
-        p->mad_stream_finish(&p->Stream);
-        p->mad_stream_init(&p->Stream);
-        break;
+      else if (!MAD_RECOVERABLE(p->Stream.error)) {
+        lsx_warn("unrecoverable MAD error");
+        return SOX_EOF;
       }
+      else sox_mp3_inputtag(ft); /* Not an audio frame */
+      continue;
     }
-  };
-
-  return SOX_EOF;
+    /* Else the header at least is valid, so this is frame n */
+    index_frame(p, n);
+    if (n >= start) {
+      if (error == -1)  /* E.g. the bit reservoir is not yet full */
+        memset(p->Frame.sbsample, 0, sizeof(p->Frame.sbsample));
+      p->mad_synth_frame(&p->Synth, &p->Frame);
+    }
+    if (n++ == target)
+      break;
+  }
+  p->FrameCount = n;
+  p->Timer = p->Frame.header.duration;
+  p->mad_timer_multiply(&p->Timer, (signed long)n);
+  p->cursamp = skip;
+  return SOX_SUCCESS;
 }
 #else /*HAVE_MAD_H*/
 static int startread(sox_format_t * ft)
@@ -29,6 +29,8 @@ typedef struct {
     int   *profilecount;
 
     float *window;
+    float *power;
+    double *work;
 } chandata_t;
 
 typedef struct {
@@ -86,6 +88,8 @@ static int sox_noiseprof_start(sox_effect_t * effp)
     data->chandata[i].sum = lsx_calloc(FREQCOUNT, sizeof(float));
     data->chandata[i].profilecount = lsx_calloc(FREQCOUNT, sizeof(int));
     data->chandata[i].window = lsx_calloc(WINDOWSIZE, sizeof(float));
+    data->chandata[i].power = lsx_calloc(FREQCOUNT, sizeof(float));
+    data->chandata[i].work = lsx_calloc(WINDOWSIZE, sizeof(double));
   }
 
   return SOX_SUCCESS;
@@ -93,10 +97,10 @@ static int sox_noiseprof_start(sox_effect_t * effp)
 
 /* Collect statistics from the complete window on channel chan. */
 static void collect_data(chandata_t* chan) {
-    float *out = lsx_calloc(FREQCOUNT, sizeof(float));
+    float *out = chan->power;
     int i;
 
-    lsx_power_spectrum_f(WINDOWSIZE, chan->window, out);
+    power_spectrum(chan->window, NULL, chan->work, out);
 
     for (i = 0; i < FREQCOUNT; i ++) {
         if (out[i] > 0) {
@@ -105,8 +109,6 @@ static void collect_data(chandata_t* chan) {
             chan->profilecount[i] ++;
         }
     }
-
-    free(out);
 }
 
 /*
@@ -195,6 +197,9 @@ static int sox_noiseprof_stop(sox_effect_t * effp)
 
         free(chan->sum);
         free(chan->profilecount);
+        free(chan->window);
+        free(chan->power);
+        free(chan->work);
     }
 
     free(data->chandata);
@@ -18,8 +18,12 @@
 typedef struct {
     float *window;
     float *lastwindow;
+    float *spare;       /* Re-used as the next window */
     float *noisegate;
     float *smoothing;
+    float *power;
+    double *dft;        /* WINDOWSIZE each */
+    double *work;
 } chandata_t;
 
 /* Holds profile information */
@@ -29,30 +33,9 @@ typedef struct {
 
     chandata_t *chandata;
     size_t bufdata;
+    double *hann;       /* lsx_apply_hann's window, WINDOWSIZE points */
 } priv_t;
 
-static void FFT(unsigned NumSamples,
-         int InverseTransform,
-         const float *RealIn, float *ImagIn, float *RealOut, float *ImagOut)
-{
-  unsigned i;
-  double * work = malloc(2 * NumSamples * sizeof(*work));
-  for (i = 0; i < 2 * NumSamples; i += 2) {
-    work[i] = RealIn[i >> 1];
-    work[i + 1] = ImagIn? ImagIn[i >> 1] : 0;
-  }
-  lsx_safe_cdft(2 * (int)NumSamples, InverseTransform? -1 : 1, work);
-  if (InverseTransform) for (i = 0; i < 2 * NumSamples; i += 2) {
-    RealOut[i >> 1] = work[i] / NumSamples;
-    ImagOut[i >> 1] = work[i + 1] / NumSamples;
-  }
-  else for (i = 0; i < 2 * NumSamples; i += 2) {
-    RealOut[i >> 1] = work[i];
-    ImagOut[i >> 1] = work[i + 1];
-  }
-  free(work);
-}
-
 /*
  * Get the options. Default file is stdin (if the audio
  * input file isn't coming from there, of course!)
@@ -96,8 +79,14 @@ static int sox_noisered_start(sox_effect_t * effp)
     for (i = 0; i < channels; i ++) {
         data->chandata[i].noisegate = lsx_calloc(FREQCOUNT, sizeof(float));
         data->chandata[i].smoothing = lsx_calloc(FREQCOUNT, sizeof(float));
-        data->chandata[i].lastwindow = NULL;
+        data->chandata[i].power = lsx_calloc(FREQCOUNT, sizeof(float));
+        data->chandata[i].dft = lsx_calloc(2 * WINDOWSIZE, sizeof(double));
+        data->chandata[i].work = data->chandata[i].dft + WINDOWSIZE;
     }
+    data->hann = lsx_malloc(WINDOWSIZE * sizeof(*data->hann));
+    for (i = 0; i < WINDOWSIZE; i ++)
+        data->hann[i] = 1;
+    lsx_apply_hann(data->hann, WINDOWSIZE);
     while (1) {
         unsigned long i1_ul;
         size_t i1;
@@ -136,28 +125,21 @@ static int sox_noisered_start(sox_effect_t * effp)
 /* Mangle a single window. Each output sample (except the first and last
  * half-window) is the result of two distinct calls to this function,
  * due to overlapping windows. */
-static void reduce_noise(chandata_t* chan, float* window, double level)
+static void reduce_noise(chandata_t* chan, float* window, double level,
+                         double const * hann)
 {
-    float *inr, *ini, *outr, *outi, *power;
-    float *smoothing = chan->smoothing;
+    float *smoothing = chan->smoothing, *power = chan->power;
+    double *dft = chan->dft;
     int i;
 
-    inr = lsx_calloc(WINDOWSIZE * 5, sizeof(float));
-    ini = inr + WINDOWSIZE;
-    outr = ini + WINDOWSIZE;
-    outi = outr + WINDOWSIZE;
-    power = outi + WINDOWSIZE;
-
     for (i = 0; i < FREQCOUNT; i ++)
         assert(smoothing[i] >= 0 && smoothing[i] <= 1);
 
-    memcpy(inr, window, WINDOWSIZE*sizeof(float));
-
-    FFT(WINDOWSIZE, 0, inr, NULL, outr, outi);
+    for (i = 0; i < WINDOWSIZE; i ++)
+        dft[i] = window[i];
+    lsx_safe_rdft(WINDOWSIZE, 1, dft);
 
-    memcpy(inr, window, WINDOWSIZE*sizeof(float));
-    lsx_apply_hann_f(inr, WINDOWSIZE);
-    lsx_power_spectrum_f(WINDOWSIZE, inr, power);
+    power_spectrum(window, hann, chan->work, power);
 
     for (i = 0; i < FREQCOUNT; i ++) {
         float smooth;
@@ -183,30 +165,20 @@ static void reduce_noise(chandata_t* chan, float* window, double level)
             smoothing[i] = 0.0;
     }
 
-    outr[0] *= smoothing[0];
-    outi[0] *= smoothing[0];
-    outr[FREQCOUNT-1] *= smoothing[FREQCOUNT-1];
-    outi[FREQCOUNT-1] *= smoothing[FREQCOUNT-1];
-
-    for (i = 1; i < FREQCOUNT-1; i ++) {
-        int j = WINDOWSIZE - i;
-        float smooth = smoothing[i];
-
-        outr[i] *= smooth;
-        outi[i] *= smooth;
-        outr[j] *= smooth;
-        outi[j] *= smooth;
+    /* Apply the gains to the packed real spectrum; this loop vectorises */
+    dft[0] *= smoothing[0];
+    dft[1] *= smoothing[FREQCOUNT-1];
+    for (i = 1; i < HALFWINDOW; i ++) {
+        dft[2*i] *= smoothing[i];
+        dft[2*i+1] *= smoothing[i];
     }
 
-    FFT(WINDOWSIZE, 1, outr, outi, inr, ini);
-    lsx_apply_hann_f(inr, WINDOWSIZE);
-
-    memcpy(window, inr, WINDOWSIZE*sizeof(float));
+    lsx_safe_rdft(WINDOWSIZE, -1, dft);
+    for (i = 0; i < WINDOWSIZE; i ++)
+        window[i] = dft[i] * (2. / WINDOWSIZE) * hann[i];
 
     for (i = 0; i < FREQCOUNT; i ++)
         assert(smoothing[i] >= 0 && smoothing[i] <= 1);
-
-    free(inr);
 }
 
 /* Do window management once we have a complete window, including mangling
@@ -220,20 +192,18 @@ static int process_window(sox_effect_t * effp, priv_t * data, unsigned chan_num,
     int first = (chan->lastwindow == NULL);
     SOX_SAMPLE_LOCALS;
 
-    if ((nextwindow = lsx_calloc(WINDOWSIZE, sizeof(float))) == NULL)
-        return SOX_EOF;
-
+    nextwindow = chan->spare? chan->spare : lsx_malloc(WINDOWSIZE * sizeof(float));
     memcpy(nextwindow, chan->window+WINDOWSIZE/2,
            sizeof(float)*(WINDOWSIZE/2));
+    memset(nextwindow+WINDOWSIZE/2, 0, sizeof(float)*(WINDOWSIZE/2));
 
-    reduce_noise(chan, chan->window, data->threshold);
+    reduce_noise(chan, chan->window, data->threshold, data->hann);
     if (!first) {
         for (j = 0; j < use; j ++) {
             float s = chan->window[j] + chan->lastwindow[WINDOWSIZE/2 + j];
             obuf[chan_num + num_chans * j] =
                 SOX_FLOAT_32BIT_TO_SAMPLE(s, effp->clips);
         }
-        free(chan->lastwindow);
     } else {
         for (j = 0; j < use; j ++) {
             assert(chan->window[j] >= -1 && chan->window[j] <= 1);
@@ -241,6 +211,7 @@ static int process_window(sox_effect_t * effp, priv_t * data, unsigned chan_num,
                 SOX_FLOAT_32BIT_TO_SAMPLE(chan->window[j], effp->clips);
         }
     }
+    chan->spare = chan->lastwindow;
     chan->lastwindow = chan->window;
     chan->window = nextwindow;
 
@@ -328,11 +299,15 @@ static int sox_noisered_stop(sox_effect_t * effp)
         chandata_t* chan = &(data->chandata[i]);
         free(chan->lastwindow);
         free(chan->window);
+        free(chan->spare);
         free(chan->smoothing);
         free(chan->noisegate);
+        free(chan->power);
+        free(chan->dft);
     }
 
     free(data->chandata);
+    free(data->hann);
 
     return (SOX_SUCCESS);
 }
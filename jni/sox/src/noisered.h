@@ -24,3 +24,20 @@
 #define WINDOWSIZE 2048
 #define HALFWINDOW (WINDOWSIZE / 2)
 #define FREQCOUNT  (HALFWINDOW + 1)
+
+/* The power spectrum (FREQCOUNT bins) of a window of WINDOWSIZE samples,
+ * optionally multiplied first by win; as lsx_power_spectrum_f, but with a
+ * caller-supplied work buffer of WINDOWSIZE doubles. */
+static void power_spectrum(float const * in, double const * win,
+    double * work, float * out)
+{
+  int i;
+
+  for (i = 0; i < WINDOWSIZE; ++i)
+    work[i] = win? (float)(in[i] * win[i]) : in[i];
+  lsx_safe_rdft(WINDOWSIZE, 1, work);
+  out[0] = sqr(work[0]);
+  for (i = 1; i < HALFWINDOW; ++i)
+    out[i] = sqr(work[2 * i]) + sqr(work[2 * i + 1]);
+  out[HALFWINDOW] = sqr(work[1]);
+}
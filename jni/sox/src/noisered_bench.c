@@ -0,0 +1,144 @@
+/* libSoX noisered effect benchmark
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifdef NDEBUG /* N.B. assert used with active statements so enable always. */
+#undef NDEBUG /* Must undef above assert.h or other that might include it. */
+#endif
+
+#include "sox.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <assert.h>
+
+#define BLOCK_FRAMES 8192
+#define PROFILE "noisered_bench.prof"
+
+static sox_sample_t * audio;
+static size_t audio_len, audio_pos;
+
+/* A source effect supplying the audio */
+static int drain(sox_effect_t * effp, sox_sample_t * obuf, size_t * osamp)
+{
+  size_t n = audio_len - audio_pos < *osamp? audio_len - audio_pos : *osamp;
+
+  (void)effp;
+  memcpy(obuf, audio + audio_pos, n * sizeof(*obuf));
+  audio_pos += n;
+  *osamp = n;
+  return n? SOX_SUCCESS : SOX_EOF;
+}
+
+/* Seconds of CPU time taken to put len samples of the audio through the
+ * given effect (or through nothing if name is NULL); output is checksummed
+ * and, if out is not NULL, written to it */
+static double run(char const * name, char * arg, sox_signalinfo_t const * in_signal,
+    size_t len, sox_sample_t * block, unsigned long * sum, FILE * out)
+{
+  static sox_effect_handler_t const source_handler = {
+    "source", NULL, SOX_EFF_MCHAN, NULL, NULL, NULL, drain, NULL, NULL, 0
+  };
+  sox_signalinfo_t signal = *in_signal;
+  sox_encodinginfo_t encoding;
+  sox_effects_chain_t * chain;
+  sox_effect_t * e;
+  clock_t start;
+  size_t i, n;
+
+  sox_init_encodinginfo(&encoding);
+  encoding.encoding = SOX_ENCODING_SIGN2;
+  encoding.bits_per_sample = 32;
+  chain = sox_create_effects_chain(&encoding, &encoding);
+
+  e = sox_create_effect(&source_handler);
+  assert(sox_add_effect(chain, e, &signal, &signal) == SOX_SUCCESS);
+  free(e);
+
+  if (name) {
+    e = sox_create_effect(sox_find_effect(name));
+    assert(sox_effect_options(e, 1, &arg) == SOX_SUCCESS);
+    assert(sox_add_effect(chain, e, &signal, &signal) == SOX_SUCCESS);
+    free(e);
+  }
+
+  audio_pos = 0, audio_len = len;
+  *sum = 2166136261u;
+  start = clock();
+  do {
+    n = sox_render_effects(chain, block, BLOCK_FRAMES);
+    for (i = 0; i < n * signal.channels; ++i)
+      *sum = ((*sum ^ (unsigned long)block[i]) * 16777619) & 0xffffffff;
+    if (out)
+      assert(fwrite(block, sizeof(*block), n * signal.channels, out) == n * signal.channels);
+  } while (n == BLOCK_FRAMES);
+  assert(sox_render_status(chain) == SOX_SUCCESS);
+  sox_delete_effects_chain(chain);
+  return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+/*
+ * Reports how fast `noisered' processes a stereo signal of tones in noise,
+ * with a profile taken from its first second (noise only), in input samples
+ * per second of CPU time and as a multiple of real time (the time to
+ * generate the input is deducted).  The output's checksum is printed, and
+ * with a file name given the output is written there as raw s32 samples,
+ * so that builds of different versions of libSoX (this program uses only
+ * the public API) may be compared for speed and output.
+ * E.g. noisered_bench 60 out.raw
+ */
+int main(int argc, char * argv[])
+{
+  double seconds = argc > 1? atof(argv[1]) : 30, base, t;
+  sox_signalinfo_t signal = {44100, 2, 32, 0, NULL};
+  FILE * out = argc > 2? fopen(argv[2], "wb") : NULL;
+  sox_sample_t * block;
+  unsigned long sum;
+  size_t i, len;
+
+  assert(argc <= 3 && seconds > 1 && (argc <= 2 || out));
+  assert(sox_init() == SOX_SUCCESS);
+
+  len = seconds * signal.rate * signal.channels;
+  audio = malloc(len * sizeof(*audio));
+  block = malloc(BLOCK_FRAMES * signal.channels * sizeof(*block));
+  srand(1);
+  for (i = 0; i < len; ++i) {
+    double x = (double)(rand() - RAND_MAX / 2) / RAND_MAX * .02, n = i / 2;
+    if (n >= signal.rate)
+      x += .2 * sin(n * (440 + 220 * (i & 1)) * 2 * M_PI / signal.rate) +
+           .1 * sin(n * 3000 * 2 * M_PI / signal.rate);
+    audio[i] = x * SOX_SAMPLE_MAX;
+  }
+
+  run("noiseprof", PROFILE, &signal, (size_t)signal.rate * signal.channels,
+      block, &sum, NULL);
+  base = run(NULL, NULL, &signal, len, block, &sum, NULL);
+  t = run("noisered", PROFILE, &signal, len, block, &sum, out) - base;
+  printf("%gs of %g-channel %gHz\n", seconds, (double)signal.channels, signal.rate);
+  printf("noisered  %8.2f Msamples/s  %7.1fx real time  checksum %08lx\n",
+      len / t * 1e-6, seconds / t, sum);
+
+  remove(PROFILE);
+  if (out)
+    fclose(out);
+  free(block);
+  free(audio);
+  sox_quit();
+  return 0;
+}
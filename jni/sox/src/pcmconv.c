@@ -0,0 +1,649 @@
+/* libSoX block conversions between linear PCM and sox_sample_t
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or (at
+ * your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/* The common encodings (signed 16 & 24-bit, and 32-bit float) are converted
+ * here a block at a time rather than through the per-sample macros in sox.h.
+ * Each public function runs the widest kernel available on this CPU over as
+ * much of the block as it can, then finishes the remainder with the scalar
+ * code, which is written in terms of those same macros.  Every kernel gives
+ * bit-identical results (and clip counts) to the scalar code.
+ *
+ * x86 kernels: SSE2 where the compiler targets it; AVX2 where the compiler
+ * supports per-function targets, selected at run time.  ARM kernels: NEON
+ * where the compiler targets it, but only with SOX_NEON_KERNELS (see
+ * profile.mk): they have yet to be built and checked on ARM, so by default
+ * ARM uses the scalar code. */
+
+#include "sox_i.h"
+
+#if defined __SSE2__ || defined _M_X64 || (defined _M_IX86_FP && _M_IX86_FP >= 2)
+  #define HAVE_SSE2_CONV
+  #include <emmintrin.h>
+  #ifdef LSX_AVX2
+    #define HAVE_AVX2_CONV
+    #include <immintrin.h>
+    #define AVX2 LSX_AVX2
+  #endif
+#elif (defined __ARM_NEON__ || defined __ARM_NEON) && defined SOX_NEON_KERNELS
+  #define HAVE_NEON_CONV
+  #include <arm_neon.h>
+#endif
+
+#ifdef HAVE_SSE2_CONV
+
+static size_t count4(__m128i mask)
+{
+  static unsigned char const bits[16] = {0,1,1,2,1,2,2,3,1,2,2,3,2,3,3,4};
+  return bits[_mm_movemask_ps(_mm_castsi128_ps(mask))];
+}
+
+static __m128i swap16_sse2(__m128i x)
+{
+  return _mm_or_si128(_mm_slli_epi16(x, 8), _mm_srli_epi16(x, 8));
+}
+
+static __m128i swap32_sse2(__m128i x)
+{
+  x = _mm_shufflelo_epi16(x, _MM_SHUFFLE(2,3,0,1));
+  return swap16_sse2(_mm_shufflehi_epi16(x, _MM_SHUFFLE(2,3,0,1)));
+}
+
+/* Choose a where mask is set, otherwise b */
+static __m128i select_sse2(__m128i mask, __m128i a, __m128i b)
+{
+  return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+static size_t s16_to_samples_sse2(
+    sox_sample_t * dst, int16_t const * src, size_t len, sox_bool swap)
+{
+  __m128i const zero = _mm_setzero_si128();
+  size_t i;
+
+  for (i = 0; i + 8 <= len; i += 8) {
+    __m128i x = _mm_loadu_si128((__m128i const *)(src + i));
+    if (swap)
+      x = swap16_sse2(x);
+    _mm_storeu_si128((__m128i *)(dst + i), _mm_unpacklo_epi16(zero, x));
+    _mm_storeu_si128((__m128i *)(dst + i + 4), _mm_unpackhi_epi16(zero, x));
+  }
+  return i;
+}
+
+static size_t samples_to_s16_sse2(int16_t * dst,
+    sox_sample_t const * src, size_t len, sox_bool swap, size_t * clips)
+{
+  __m128i const limit = _mm_set1_epi32(SOX_SAMPLE_MAX - 0x8000);
+  __m128i const round = _mm_set1_epi32(0x8000), max = _mm_set1_epi32(0x7fff);
+  size_t i;
+
+  for (i = 0; i + 8 <= len; i += 8) {
+    __m128i a = _mm_loadu_si128((__m128i const *)(src + i));
+    __m128i b = _mm_loadu_si128((__m128i const *)(src + i + 4));
+    __m128i ca = _mm_cmpgt_epi32(a, limit), cb = _mm_cmpgt_epi32(b, limit);
+    a = select_sse2(ca, max, _mm_srai_epi32(_mm_add_epi32(a, round), 16));
+    b = select_sse2(cb, max, _mm_srai_epi32(_mm_add_epi32(b, round), 16));
+    a = _mm_packs_epi32(a, b);
+    if (swap)
+      a = swap16_sse2(a);
+    _mm_storeu_si128((__m128i *)(dst + i), a);
+    *clips += count4(ca) + count4(cb);
+  }
+  return i;
+}
+
+static __m128i f32_to_samples4_sse2(__m128i x, size_t * clips)
+{
+  __m128 const scale = _mm_castsi128_ps(_mm_set1_epi32(0x4f000000)); /* 2^31 */
+  __m128 const min = _mm_castsi128_ps(_mm_set1_epi32((int)0xcf000000));
+  __m128 v = _mm_mul_ps(_mm_castsi128_ps(x), scale);
+  /* Out-of-range (and NaN) lanes convert to SOX_SAMPLE_MIN */
+  __m128i over = _mm_castps_si128(_mm_cmpge_ps(v, scale));
+
+  *clips += count4(_mm_castps_si128(
+        _mm_or_ps(_mm_cmpgt_ps(v, scale), _mm_cmplt_ps(v, min))));
+  return select_sse2(over, _mm_set1_epi32(SOX_SAMPLE_MAX), _mm_cvttps_epi32(v));
+}
+
+static size_t f32_to_samples_sse2(sox_sample_t * dst,
+    float const * src, size_t len, sox_bool swap, size_t * clips)
+{
+  size_t i;
+
+  for (i = 0; i + 4 <= len; i += 4) {
+    __m128i x = _mm_loadu_si128((__m128i const *)(src + i));
+    if (swap)
+      x = swap32_sse2(x);
+    _mm_storeu_si128((__m128i *)(dst + i), f32_to_samples4_sse2(x, clips));
+  }
+  return i;
+}
+
+static size_t f32x2_to_samples_sse2(sox_sample_t * dst,
+    float const * l, float const * r, size_t len, size_t * clips)
+{
+  size_t i;
+
+  for (i = 0; i + 4 <= len; i += 4) {
+    __m128i a = f32_to_samples4_sse2(_mm_loadu_si128((__m128i const *)(l + i)), clips);
+    __m128i b = f32_to_samples4_sse2(_mm_loadu_si128((__m128i const *)(r + i)), clips);
+    _mm_storeu_si128((__m128i *)(dst + 2 * i), _mm_unpacklo_epi32(a, b));
+    _mm_storeu_si128((__m128i *)(dst + 2 * i + 4), _mm_unpackhi_epi32(a, b));
+  }
+  return i;
+}
+
+static size_t s32_to_samples_sse2(sox_sample_t * dst,
+    int32_t const * src, size_t len, unsigned shift)
+{
+  __m128i const n = _mm_cvtsi32_si128((int)shift);
+  size_t i;
+
+  for (i = 0; i + 4 <= len; i += 4)
+    _mm_storeu_si128((__m128i *)(dst + i),
+        _mm_sll_epi32(_mm_loadu_si128((__m128i const *)(src + i)), n));
+  return i;
+}
+
+static size_t s32x2_to_samples_sse2(sox_sample_t * dst,
+    int32_t const * l, int32_t const * r, size_t len, unsigned shift)
+{
+  __m128i const n = _mm_cvtsi32_si128((int)shift);
+  size_t i;
+
+  for (i = 0; i + 4 <= len; i += 4) {
+    __m128i a = _mm_sll_epi32(_mm_loadu_si128((__m128i const *)(l + i)), n);
+    __m128i b = _mm_sll_epi32(_mm_loadu_si128((__m128i const *)(r + i)), n);
+    _mm_storeu_si128((__m128i *)(dst + 2 * i), _mm_unpacklo_epi32(a, b));
+    _mm_storeu_si128((__m128i *)(dst + 2 * i + 4), _mm_unpackhi_epi32(a, b));
+  }
+  return i;
+}
+
+static size_t samples_to_f32_sse2(float * dst,
+    sox_sample_t const * src, size_t len, sox_bool swap, size_t * clips)
+{
+  __m128i const limit = _mm_set1_epi32(SOX_SAMPLE_MAX - 128);
+  __m128i const round = _mm_set1_epi32(128), mask = _mm_set1_epi32(~255);
+  __m128i const one = _mm_set1_epi32(0x3f800000);
+  __m128 const scale = _mm_castsi128_ps(_mm_set1_epi32(0x30000000)); /* 2^-31 */
+  size_t i;
+
+  for (i = 0; i + 4 <= len; i += 4) {
+    __m128i x = _mm_loadu_si128((__m128i const *)(src + i));
+    __m128i c = _mm_cmpgt_epi32(x, limit);
+    __m128 v = _mm_cvtepi32_ps(_mm_and_si128(_mm_add_epi32(x, round), mask));
+    x = select_sse2(c, one, _mm_castps_si128(_mm_mul_ps(v, scale)));
+    if (swap)
+      x = swap32_sse2(x);
+    _mm_storeu_si128((__m128i *)(dst + i), x);
+    *clips += count4(c);
+  }
+  return i;
+}
+
+#endif
+
+#ifdef HAVE_AVX2_CONV
+
+static AVX2 size_t count8(__m256i mask)
+{
+  return __builtin_popcount((unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(mask)));
+}
+
+static AVX2 __m256i swap16_avx2(__m256i x)
+{
+  return _mm256_or_si256(_mm256_slli_epi16(x, 8), _mm256_srli_epi16(x, 8));
+}
+
+static AVX2 size_t s16_to_samples_avx2(
+    sox_sample_t * dst, int16_t const * src, size_t len, sox_bool swap)
+{
+  size_t i;
+
+  for (i = 0; i + 16 <= len; i += 16) {
+    __m256i x = _mm256_loadu_si256((__m256i const *)(src + i));
+    if (swap)
+      x = swap16_avx2(x);
+    _mm256_storeu_si256((__m256i *)(dst + i), _mm256_slli_epi32(
+          _mm256_cvtepi16_epi32(_mm256_castsi256_si128(x)), 16));
+    _mm256_storeu_si256((__m256i *)(dst + i + 8), _mm256_slli_epi32(
+          _mm256_cvtepi16_epi32(_mm256_extracti128_si256(x, 1)), 16));
+  }
+  return i;
+}
+
+static AVX2 size_t samples_to_s16_avx2(int16_t * dst,
+    sox_sample_t const * src, size_t len, sox_bool swap, size_t * clips)
+{
+  __m256i const limit = _mm256_set1_epi32(SOX_SAMPLE_MAX - 0x8000);
+  __m256i const round = _mm256_set1_epi32(0x8000);
+  size_t i;
+
+  for (i = 0; i + 16 <= len; i += 16) {
+    __m256i a = _mm256_loadu_si256((__m256i const *)(src + i));
+    __m256i b = _mm256_loadu_si256((__m256i const *)(src + i + 8));
+    *clips += count8(_mm256_cmpgt_epi32(a, limit));
+    *clips += count8(_mm256_cmpgt_epi32(b, limit));
+    /* Clamping to the limit makes clipped lanes round to 0x7fff */
+    a = _mm256_srai_epi32(_mm256_add_epi32(_mm256_min_epi32(a, limit), round), 16);
+    b = _mm256_srai_epi32(_mm256_add_epi32(_mm256_min_epi32(b, limit), round), 16);
+    a = _mm256_permute4x64_epi64(_mm256_packs_epi32(a, b), _MM_SHUFFLE(3,1,2,0));
+    if (swap)
+      a = swap16_avx2(a);
+    _mm256_storeu_si256((__m256i *)(dst + i), a);
+  }
+  return i;
+}
+
+/* 24-bit samples are moved four at a time through 16-byte registers, so
+ * loads and stores may touch the 4 bytes following the 12 converted; the
+ * loops stop while that is still inside the caller's buffer. */
+static AVX2 size_t s24_to_samples_avx2(
+    sox_sample_t * dst, uint8_t const * src, size_t len, sox_bool big_endian)
+{
+  static int8_t const order[2][16] = {
+    {-1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11},
+    {-1, 2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9}};
+  __m128i const shuffle = _mm_loadu_si128((__m128i const *)order[!!big_endian]);
+  size_t i;
+
+  for (i = 0; i + 6 <= len; i += 4)
+    _mm_storeu_si128((__m128i *)(dst + i), _mm_shuffle_epi8(
+          _mm_loadu_si128((__m128i const *)(src + 3 * i)), shuffle));
+  return i;
+}
+
+static AVX2 size_t samples_to_s24_avx2(uint8_t * dst,
+    sox_sample_t const * src, size_t len, sox_bool big_endian, size_t * clips)
+{
+  static int8_t const order[2][16] = {
+    {0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1},
+    {2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1}};
+  __m128i const shuffle = _mm_loadu_si128((__m128i const *)order[!!big_endian]);
+  __m128i const limit = _mm_set1_epi32(SOX_SAMPLE_MAX - 0x80);
+  __m128i const round = _mm_set1_epi32(0x80);
+  size_t i;
+
+  for (i = 0; i + 6 <= len; i += 4) {
+    __m128i x = _mm_loadu_si128((__m128i const *)(src + i));
+    *clips += count4(_mm_cmpgt_epi32(x, limit));
+    x = _mm_srai_epi32(_mm_add_epi32(_mm_min_epi32(x, limit), round), 8);
+    _mm_storeu_si128((__m128i *)(dst + 3 * i), _mm_shuffle_epi8(x, shuffle));
+  }
+  return i;
+}
+
+#endif
+
+#ifdef HAVE_NEON_CONV
+
+static size_t s16_to_samples_neon(
+    sox_sample_t * dst, int16_t const * src, size_t len, sox_bool swap)
+{
+  size_t i;
+
+  for (i = 0; i + 8 <= len; i += 8) {
+    int16x8_t x = vld1q_s16(src + i);
+    if (swap)
+      x = vreinterpretq_s16_u8(vrev16q_u8(vreinterpretq_u8_s16(x)));
+    vst1q_s32(dst + i, vshll_n_s16(vget_low_s16(x), 16));
+    vst1q_s32(dst + i + 4, vshll_n_s16(vget_high_s16(x), 16));
+  }
+  return i;
+}
+
+static size_t samples_to_s16_neon(int16_t * dst,
+    sox_sample_t const * src, size_t len, sox_bool swap, size_t * clips)
+{
+  int32x4_t const limit = vdupq_n_s32(SOX_SAMPLE_MAX - 0x8000);
+  uint32x4_t n = vdupq_n_u32(0);
+  size_t i;
+
+  for (i = 0; i + 8 <= len; i += 8) {
+    int32x4_t a = vld1q_s32(src + i), b = vld1q_s32(src + i + 4);
+    /* Saturation gives 0x7fff for exactly the lanes that clip */
+    int16x8_t x = vcombine_s16(vqrshrn_n_s32(a, 16), vqrshrn_n_s32(b, 16));
+    n = vsubq_u32(n, vcgtq_s32(a, limit));
+    n = vsubq_u32(n, vcgtq_s32(b, limit));
+    if (swap)
+      x = vreinterpretq_s16_u8(vrev16q_u8(vreinterpretq_u8_s16(x)));
+    vst1q_s16(dst + i, x);
+  }
+  *clips += vgetq_lane_u32(n, 0) + vgetq_lane_u32(n, 1) +
+            vgetq_lane_u32(n, 2) + vgetq_lane_u32(n, 3);
+  return i;
+}
+
+static size_t s24_to_samples_neon(
+    sox_sample_t * dst, uint8_t const * src, size_t len, sox_bool big_endian)
+{
+  size_t i;
+
+  for (i = 0; i + 8 <= len; i += 8) {
+    uint8x8x3_t b = vld3_u8(src + 3 * i);
+    uint8x8_t lo = big_endian? b.val[2] : b.val[0];
+    uint8x8_t hi = big_endian? b.val[0] : b.val[2];
+    uint16x8x2_t x = vzipq_u16(vshll_n_u8(lo, 8),
+        vorrq_u16(vshll_n_u8(hi, 8), vmovl_u8(b.val[1])));
+    vst1q_s32(dst + i, vreinterpretq_s32_u16(x.val[0]));
+    vst1q_s32(dst + i + 4, vreinterpretq_s32_u16(x.val[1]));
+  }
+  return i;
+}
+
+static size_t samples_to_s24_neon(uint8_t * dst,
+    sox_sample_t const * src, size_t len, sox_bool big_endian, size_t * clips)
+{
+  int32x4_t const limit = vdupq_n_s32(SOX_SAMPLE_MAX - 0x80);
+  int32x4_t const round = vdupq_n_s32(0x80);
+  uint32x4_t n = vdupq_n_u32(0);
+  size_t i;
+
+  for (i = 0; i + 8 <= len; i += 8) {
+    int32x4_t a = vld1q_s32(src + i), b = vld1q_s32(src + i + 4);
+    uint32x4_t ua, ub;
+    uint8x8x3_t x;
+    n = vsubq_u32(n, vcgtq_s32(a, limit));
+    n = vsubq_u32(n, vcgtq_s32(b, limit));
+    ua = vreinterpretq_u32_s32(vshrq_n_s32(vaddq_s32(vminq_s32(a, limit), round), 8));
+    ub = vreinterpretq_u32_s32(vshrq_n_s32(vaddq_s32(vminq_s32(b, limit), round), 8));
+    x.val[0] = vmovn_u16(vcombine_u16(vmovn_u32(ua), vmovn_u32(ub)));
+    x.val[1] = vmovn_u16(vcombine_u16(vshrn_n_u32(ua, 8), vshrn_n_u32(ub, 8)));
+    x.val[2] = vmovn_u16(vcombine_u16(vshrn_n_u32(ua, 16), vshrn_n_u32(ub, 16)));
+    if (big_endian) {
+      uint8x8_t t = x.val[0];
+      x.val[0] = x.val[2], x.val[2] = t;
+    }
+    vst3_u8(dst + 3 * i, x);
+  }
+  *clips += vgetq_lane_u32(n, 0) + vgetq_lane_u32(n, 1) +
+            vgetq_lane_u32(n, 2) + vgetq_lane_u32(n, 3);
+  return i;
+}
+
+/* Conversion saturates, as does the scalar VCVT; clip counts go to *n */
+static int32x4_t f32_to_samples4_neon(float32x4_t v, uint32x4_t * n)
+{
+  float32x4_t const max = vdupq_n_f32(SOX_SAMPLE_MAX + 1.f);
+  float32x4_t const min = vdupq_n_f32(SOX_SAMPLE_MIN);
+
+  v = vmulq_f32(v, max);
+  *n = vsubq_u32(*n, vorrq_u32(vcgtq_f32(v, max), vcltq_f32(v, min)));
+  return vcvtq_s32_f32(v);
+}
+
+static size_t f32_to_samples_neon(sox_sample_t * dst,
+    float const * src, size_t len, sox_bool swap, size_t * clips)
+{
+  uint32x4_t n = vdupq_n_u32(0);
+  size_t i;
+
+  for (i = 0; i + 4 <= len; i += 4) {
+    float32x4_t v = vld1q_f32(src + i);
+    if (swap)
+      v = vreinterpretq_f32_u8(vrev32q_u8(vreinterpretq_u8_f32(v)));
+    vst1q_s32(dst + i, f32_to_samples4_neon(v, &n));
+  }
+  *clips += vgetq_lane_u32(n, 0) + vgetq_lane_u32(n, 1) +
+            vgetq_lane_u32(n, 2) + vgetq_lane_u32(n, 3);
+  return i;
+}
+
+static size_t f32x2_to_samples_neon(sox_sample_t * dst,
+    float const * l, float const * r, size_t len, size_t * clips)
+{
+  uint32x4_t n = vdupq_n_u32(0);
+  size_t i;
+
+  for (i = 0; i + 4 <= len; i += 4) {
+    int32x4x2_t x;
+    x.val[0] = f32_to_samples4_neon(vld1q_f32(l + i), &n);
+    x.val[1] = f32_to_samples4_neon(vld1q_f32(r + i), &n);
+    vst2q_s32(dst + 2 * i, x);
+  }
+  *clips += vgetq_lane_u32(n, 0) + vgetq_lane_u32(n, 1) +
+            vgetq_lane_u32(n, 2) + vgetq_lane_u32(n, 3);
+  return i;
+}
+
+static size_t s32_to_samples_neon(sox_sample_t * dst,
+    int32_t const * src, size_t len, unsigned shift)
+{
+  int32x4_t const n = vdupq_n_s32((int)shift);
+  size_t i;
+
+  for (i = 0; i + 4 <= len; i += 4)
+    vst1q_s32(dst + i, vshlq_s32(vld1q_s32(src + i), n));
+  return i;
+}
+
+static size_t s32x2_to_samples_neon(sox_sample_t * dst,
+    int32_t const * l, int32_t const * r, size_t len, unsigned shift)
+{
+  int32x4_t const n = vdupq_n_s32((int)shift);
+  size_t i;
+
+  for (i = 0; i + 4 <= len; i += 4) {
+    int32x4x2_t x;
+    x.val[0] = vshlq_s32(vld1q_s32(l + i), n);
+    x.val[1] = vshlq_s32(vld1q_s32(r + i), n);
+    vst2q_s32(dst + 2 * i, x);
+  }
+  return i;
+}
+
+static size_t samples_to_f32_neon(float * dst,
+    sox_sample_t const * src, size_t len, sox_bool swap, size_t * clips)
+{
+  int32x4_t const limit = vdupq_n_s32(SOX_SAMPLE_MAX - 128);
+  int32x4_t const round = vdupq_n_s32(128), mask = vdupq_n_s32(~255);
+  float32x4_t const one = vdupq_n_f32(1);
+  uint32x4_t n = vdupq_n_u32(0);
+  size_t i;
+
+  for (i = 0; i + 4 <= len; i += 4) {
+    int32x4_t x = vld1q_s32(src + i);
+    uint32x4_t c = vcgtq_s32(x, limit);
+    float32x4_t v = vmulq_n_f32(vcvtq_f32_s32(
+          vandq_s32(vaddq_s32(x, round), mask)), 1.f / (SOX_SAMPLE_MAX + 1.f));
+    v = vbslq_f32(c, one, v);
+    if (swap)
+      v = vreinterpretq_f32_u8(vrev32q_u8(vreinterpretq_u8_f32(v)));
+    vst1q_f32(dst + i, v);
+    n = vsubq_u32(n, c);
+  }
+  *clips += vgetq_lane_u32(n, 0) + vgetq_lane_u32(n, 1) +
+            vgetq_lane_u32(n, 2) + vgetq_lane_u32(n, 3);
+  return i;
+}
+
+#endif
+
+static void swapf(float * f)
+{
+  union {float f; uint32_t u;} x;
+
+  x.f = *f;
+  x.u = lsx_swapdw(x.u);
+  *f = x.f;
+}
+
+void lsx_s16_to_samples(
+    sox_sample_t * dst, int16_t const * src, size_t len, sox_bool swap)
+{
+  size_t i = 0;
+
+#if defined HAVE_AVX2_CONV
+  if (lsx_have_avx2())
+    i = s16_to_samples_avx2(dst, src, len, swap);
+  else
+#endif
+#if defined HAVE_SSE2_CONV
+  i = s16_to_samples_sse2(dst, src, len, swap);
+#elif defined HAVE_NEON_CONV
+  i = s16_to_samples_neon(dst, src, len, swap);
+#endif
+  for (; i < len; ++i)
+    dst[i] = SOX_SIGNED_TO_SAMPLE(16, swap? (int16_t)lsx_swapw((uint16_t)src[i]) : src[i]);
+}
+
+size_t lsx_samples_to_s16(
+    int16_t * dst, sox_sample_t const * src, size_t len, sox_bool swap)
+{
+  size_t i = 0, clips = 0;
+  SOX_SAMPLE_LOCALS;
+
+#if defined HAVE_AVX2_CONV
+  if (lsx_have_avx2())
+    i = samples_to_s16_avx2(dst, src, len, swap, &clips);
+  else
+#endif
+#if defined HAVE_SSE2_CONV
+  i = samples_to_s16_sse2(dst, src, len, swap, &clips);
+#elif defined HAVE_NEON_CONV
+  i = samples_to_s16_neon(dst, src, len, swap, &clips);
+#endif
+  for (; i < len; ++i) {
+    uint16_t x = SOX_SAMPLE_TO_SIGNED_16BIT(src[i], clips);
+    dst[i] = swap? lsx_swapw(x) : x;
+  }
+  return clips;
+}
+
+void lsx_s24_to_samples(
+    sox_sample_t * dst, uint8_t const * src, size_t len, sox_bool big_endian)
+{
+  size_t i = 0;
+
+#if defined HAVE_AVX2_CONV
+  if (lsx_have_avx2())
+    i = s24_to_samples_avx2(dst, src, len, big_endian);
+#elif defined HAVE_NEON_CONV
+  i = s24_to_samples_neon(dst, src, len, big_endian);
+#endif
+  for (; i < len; ++i) {
+    uint8_t const * p = src + 3 * i;
+    dst[i] = SOX_SIGNED_TO_SAMPLE(24, big_endian?
+        p[2] | (p[1] << 8) | (p[0] << 16) : p[0] | (p[1] << 8) | (p[2] << 16));
+  }
+}
+
+size_t lsx_samples_to_s24(
+    uint8_t * dst, sox_sample_t const * src, size_t len, sox_bool big_endian)
+{
+  size_t i = 0, clips = 0;
+  SOX_SAMPLE_LOCALS;
+
+#if defined HAVE_AVX2_CONV
+  if (lsx_have_avx2())
+    i = samples_to_s24_avx2(dst, src, len, big_endian, &clips);
+#elif defined HAVE_NEON_CONV
+  i = samples_to_s24_neon(dst, src, len, big_endian, &clips);
+#endif
+  for (; i < len; ++i) {
+    uint8_t * p = dst + 3 * i;
+    int24_t x = SOX_SAMPLE_TO_SIGNED_24BIT(src[i], clips);
+    p[big_endian? 2 : 0] = x & 0xff;
+    p[1] = (x >> 8) & 0xff;
+    p[big_endian? 0 : 2] = (x >> 16) & 0xff;
+  }
+  return clips;
+}
+
+size_t lsx_f32_to_samples(
+    sox_sample_t * dst, float const * src, size_t len, sox_bool swap)
+{
+  size_t i = 0, clips = 0;
+  SOX_SAMPLE_LOCALS;
+
+#if defined HAVE_SSE2_CONV
+  i = f32_to_samples_sse2(dst, src, len, swap, &clips);
+#elif defined HAVE_NEON_CONV
+  i = f32_to_samples_neon(dst, src, len, swap, &clips);
+#endif
+  for (; i < len; ++i) {
+    float x = src[i];
+    if (swap)
+      swapf(&x);
+    dst[i] = SOX_FLOAT_32BIT_TO_SAMPLE(x, clips);
+  }
+  return clips;
+}
+
+void lsx_s32_planar_to_samples(sox_sample_t * dst,
+    int32_t const * const * src, size_t len, unsigned channels, unsigned bits)
+{
+  size_t i = 0;
+  unsigned c;
+
+#if defined HAVE_SSE2_CONV
+  if (channels == 1)
+    i = s32_to_samples_sse2(dst, src[0], len, 32 - bits);
+  else if (channels == 2)
+    i = s32x2_to_samples_sse2(dst, src[0], src[1], len, 32 - bits);
+#elif defined HAVE_NEON_CONV
+  if (channels == 1)
+    i = s32_to_samples_neon(dst, src[0], len, 32 - bits);
+  else if (channels == 2)
+    i = s32x2_to_samples_neon(dst, src[0], src[1], len, 32 - bits);
+#endif
+  for (dst += i * channels; i < len; ++i)
+    for (c = 0; c < channels; ++c)
+      *dst++ = SOX_SIGNED_TO_SAMPLE(bits, src[c][i]);
+}
+
+size_t lsx_f32_planar_to_samples(sox_sample_t * dst,
+    float const * const * src, size_t len, unsigned channels)
+{
+  size_t i = 0, clips = 0;
+  unsigned c;
+  SOX_SAMPLE_LOCALS;
+
+  if (channels == 1)
+    return lsx_f32_to_samples(dst, src[0], len, sox_false);
+#if defined HAVE_SSE2_CONV
+  if (channels == 2)
+    i = f32x2_to_samples_sse2(dst, src[0], src[1], len, &clips);
+#elif defined HAVE_NEON_CONV
+  if (channels == 2)
+    i = f32x2_to_samples_neon(dst, src[0], src[1], len, &clips);
+#endif
+  for (dst += i * channels; i < len; ++i)
+    for (c = 0; c < channels; ++c)
+      *dst++ = SOX_FLOAT_32BIT_TO_SAMPLE(src[c][i], clips);
+  return clips;
+}
+
+size_t lsx_samples_to_f32(
+    float * dst, sox_sample_t const * src, size_t len, sox_bool swap)
+{
+  size_t i = 0, clips = 0;
+  SOX_SAMPLE_LOCALS;
+
+#if defined HAVE_SSE2_CONV
+  i = samples_to_f32_sse2(dst, src, len, swap, &clips);
+#elif defined HAVE_NEON_CONV
+  i = samples_to_f32_neon(dst, src, len, swap, &clips);
+#endif
+  for (; i < len; ++i) {
+    dst[i] = SOX_SAMPLE_TO_FLOAT_32BIT(src[i], clips);
+    if (swap)
+      swapf(dst + i);
+  }
+  return clips;
+}
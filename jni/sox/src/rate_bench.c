@@ -0,0 +1,128 @@
+/* libSoX rate effect benchmark
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifdef NDEBUG /* N.B. assert used with active statements so enable always. */
+#undef NDEBUG /* Must undef above assert.h or other that might include it. */
+#endif
+
+#include "sox.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <assert.h>
+
+#define BLOCK_FRAMES 8192
+
+static sox_sample_t * noise;
+static size_t noise_len, noise_pos;
+
+/* A source effect supplying the noise */
+static int drain(sox_effect_t * effp, sox_sample_t * obuf, size_t * osamp)
+{
+  size_t n = noise_len - noise_pos < *osamp? noise_len - noise_pos : *osamp;
+
+  (void)effp;
+  memcpy(obuf, noise + noise_pos, n * sizeof(*obuf));
+  noise_pos += n;
+  *osamp = n;
+  return n? SOX_SUCCESS : SOX_EOF;
+}
+
+/* Seconds of CPU time taken to put the noise through `rate' at the given
+ * quality, or through nothing if quality is NULL */
+static double run(char const * quality, sox_signalinfo_t const * in_signal,
+    double out_rate, sox_sample_t * block)
+{
+  static sox_effect_handler_t const source_handler = {
+    "source", NULL, SOX_EFF_MCHAN, NULL, NULL, NULL, drain, NULL, NULL, 0
+  };
+  sox_signalinfo_t signal = *in_signal, out_signal = *in_signal;
+  sox_encodinginfo_t encoding;
+  sox_effects_chain_t * chain;
+  sox_effect_t * e;
+  char rate[32], * args[2];
+  clock_t start;
+
+  sox_init_encodinginfo(&encoding);
+  encoding.encoding = SOX_ENCODING_SIGN2;
+  encoding.bits_per_sample = 32;
+  chain = sox_create_effects_chain(&encoding, &encoding);
+
+  e = sox_create_effect(&source_handler);
+  assert(sox_add_effect(chain, e, &signal, &signal) == SOX_SUCCESS);
+  free(e);
+
+  if (quality) {
+    out_signal.rate = out_rate;
+    sprintf(rate, "%g", out_rate);
+    args[0] = (char *)quality, args[1] = rate;
+    e = sox_create_effect(sox_find_effect("rate"));
+    assert(sox_effect_options(e, 2, args) == SOX_SUCCESS);
+    assert(sox_add_effect(chain, e, &signal, &out_signal) == SOX_SUCCESS);
+    free(e);
+  }
+
+  noise_pos = 0;
+  start = clock();
+  while (sox_render_effects(chain, block, BLOCK_FRAMES) == BLOCK_FRAMES);
+  assert(sox_render_status(chain) == SOX_SUCCESS);
+  sox_delete_effects_chain(chain);
+  return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+/*
+ * Reports how fast each quality of the `rate' effect converts a stereo noise
+ * signal, in input samples per second of CPU time and as a multiple of real
+ * time (the time to generate the input is deducted).
+ * E.g. rate_bench 60 44100 48000
+ */
+int main(int argc, char * argv[])
+{
+  static char const * const qualities[] = {"-q", "-l", "-m", "-h", "-v"};
+  double seconds = argc > 1? atof(argv[1]) : 30;
+  sox_signalinfo_t signal = {44100, 2, 32, 0, NULL};
+  double out_rate = argc > 3? atof(argv[3]) : 48000, base;
+  sox_sample_t * block;
+  size_t i;
+
+  if (argc > 2)
+    signal.rate = atof(argv[2]);
+  assert(argc <= 4 && seconds > 0 && signal.rate > 0 && out_rate > 0);
+  assert(sox_init() == SOX_SUCCESS);
+
+  noise_len = seconds * signal.rate * signal.channels;
+  noise = malloc(noise_len * sizeof(*noise));
+  block = malloc(BLOCK_FRAMES * signal.channels * sizeof(*block));
+  srand(1);
+  for (i = 0; i < noise_len; ++i)
+    noise[i] = (sox_sample_t)((rand() - RAND_MAX / 2) * (SOX_SAMPLE_MAX / 2 / (RAND_MAX / 2)));
+
+  base = run(NULL, &signal, out_rate, block);
+  printf("%gs of %g-channel %gHz -> %gHz\n", seconds, (double)signal.channels,
+      signal.rate, out_rate);
+  for (i = 0; i < sizeof(qualities) / sizeof(*qualities); ++i) {
+    double t = run(qualities[i], &signal, out_rate, block) - base;
+    printf("rate %s  %8.2f Msamples/s  %7.1fx real time\n", qualities[i],
+        noise_len / t * 1e-6, seconds / t);
+  }
+
+  free(block);
+  free(noise);
+  sox_quit();
+  return 0;
+}
@@ -0,0 +1,416 @@
+/* Effect: change sample rate     Copyright (c) 2008 robs@users.sourceforge.net
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or (at
+ * your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/* Vector kernels for the poly-phase FIR stage, in double precision and (for
+ * qualities whose stop-band is well within its reach) in single precision,
+ * with float coefs and float arithmetic.
+ *
+ * The double kernels add the taps up in a different order from the scalar
+ * code, so results can differ from it in the last bit or so.  The float
+ * kernels stay within about 2^-21 of full scale of the double ones, far below
+ * the 100dB or so rejection of the filters they are used for.
+ *
+ * Kernels are built for whatever the compiler targets (SSE2 on x86, NEON on
+ * ARM, in double precision on AArch64 only), plus AVX2 as in pcmconv.c.  The
+ * NEON ones are yet to be compared with the scalar code on ARM, so are built
+ * only with SOX_NEON_KERNELS (see profile.mk). */
+
+typedef sample_t (* poly_fir_dot_t)(sample_t const * at, void const * coefs,
+    int len, sample_t x);
+
+#if defined __SSE2__ || defined _M_X64 || (defined _M_IX86_FP && _M_IX86_FP >= 2)
+  #define HAVE_SSE2_FIR
+  #include <emmintrin.h>
+  #ifdef LSX_AVX2
+    #define HAVE_AVX2_FIR
+    #include <immintrin.h>
+  #endif
+#elif (defined __ARM_NEON__ || defined __ARM_NEON) && defined SOX_NEON_KERNELS
+  #define HAVE_NEON_FIR
+  #include <arm_neon.h>
+#endif
+
+#define POLY_FIR_DOTS(prefix) \
+  {prefix##0, prefix##1, prefix##2, prefix##3}
+
+/* Plain FIR (no coef interpolation) in scalar code, for when there is no
+ * vector kernel */
+#define TARGET
+#define VEC_LEN         1
+#define coef_t          double
+#define vec_t           sample_t
+#define vec_zero        0
+#define vec_set1(x)     (x)
+#define vec_load(p)     (*(p))
+#define vec_load_in(p)  (*(p))
+#define vec_add(a, b)   ((a) + (b))
+#define vec_mul(a, b)   ((a) * (b))
+#define vec_sum(v)      (v)
+
+#define FUNCTION dot_0
+#define COEF_INTERP 0
+#include "rate_poly_fir_vec.h"
+
+#undef TARGET
+#undef VEC_LEN
+#undef coef_t
+#undef vec_t
+#undef vec_zero
+#undef vec_set1
+#undef vec_load
+#undef vec_load_in
+#undef vec_add
+#undef vec_mul
+#undef vec_sum
+
+#if defined HAVE_SSE2_FIR
+
+#define TARGET
+#define VEC_LEN         2
+#define coef_t          double
+#define vec_t           __m128d
+#define vec_zero        _mm_setzero_pd()
+#define vec_set1(x)     _mm_set1_pd(x)
+#define vec_load(p)     _mm_loadu_pd(p)
+#define vec_load_in(p)  _mm_loadu_pd(p)
+#define vec_add         _mm_add_pd
+#define vec_mul         _mm_mul_pd
+#define vec_sum(v)      sum_sse2(v)
+
+static sample_t sum_sse2(__m128d v)
+{
+  return _mm_cvtsd_f64(_mm_add_sd(v, _mm_unpackhi_pd(v, v)));
+}
+
+#define FUNCTION dot_sse2_0
+#define COEF_INTERP 0
+#include "rate_poly_fir_vec.h"
+#define FUNCTION dot_sse2_1
+#define COEF_INTERP 1
+#include "rate_poly_fir_vec.h"
+#define FUNCTION dot_sse2_2
+#define COEF_INTERP 2
+#include "rate_poly_fir_vec.h"
+#define FUNCTION dot_sse2_3
+#define COEF_INTERP 3
+#include "rate_poly_fir_vec.h"
+
+#undef VEC_LEN
+#undef coef_t
+#undef vec_t
+#undef vec_zero
+#undef vec_set1
+#undef vec_load
+#undef vec_load_in
+#undef vec_add
+#undef vec_mul
+#undef vec_sum
+
+#define VEC_LEN         4
+#define coef_t          float
+#define vec_t           __m128
+#define vec_zero        _mm_setzero_ps()
+#define vec_set1(x)     set1f_sse2(x)
+#define vec_load(p)     _mm_loadu_ps(p)
+#define vec_load_in(p)  _mm_movelh_ps( \
+    _mm_cvtpd_ps(_mm_loadu_pd(p)), _mm_cvtpd_ps(_mm_loadu_pd((p) + 2)))
+#define vec_add         _mm_add_ps
+#define vec_mul         _mm_mul_ps
+#define vec_sum(v)      sumf_sse2(v)
+
+static __m128 set1f_sse2(double x)
+{
+  __m128 v = _mm_cvtpd_ps(_mm_set1_pd(x));
+  return _mm_movelh_ps(v, v);
+}
+
+static sample_t sumf_sse2(__m128 v)
+{
+  v = _mm_add_ps(v, _mm_movehl_ps(v, v));
+  return _mm_cvtss_f32(_mm_add_ss(v, _mm_shuffle_ps(v, v, 1)));
+}
+
+#define FUNCTION dotf_sse2_0
+#define COEF_INTERP 0
+#include "rate_poly_fir_vec.h"
+#define FUNCTION dotf_sse2_1
+#define COEF_INTERP 1
+#include "rate_poly_fir_vec.h"
+#define FUNCTION dotf_sse2_2
+#define COEF_INTERP 2
+#include "rate_poly_fir_vec.h"
+#define FUNCTION dotf_sse2_3
+#define COEF_INTERP 3
+#include "rate_poly_fir_vec.h"
+
+#undef TARGET
+#undef VEC_LEN
+#undef coef_t
+#undef vec_t
+#undef vec_zero
+#undef vec_set1
+#undef vec_load
+#undef vec_load_in
+#undef vec_add
+#undef vec_mul
+#undef vec_sum
+
+#endif
+
+#if defined HAVE_AVX2_FIR
+
+#define TARGET          LSX_AVX2
+#define VEC_LEN         4
+#define coef_t          double
+#define vec_t           __m256d
+#define vec_zero        _mm256_setzero_pd()
+#define vec_set1(x)     _mm256_set1_pd(x)
+#define vec_load(p)     _mm256_loadu_pd(p)
+#define vec_load_in(p)  _mm256_loadu_pd(p)
+#define vec_add         _mm256_add_pd
+#define vec_mul         _mm256_mul_pd
+#define vec_sum(v)      sum_avx2(v)
+
+static TARGET sample_t sum_avx2(__m256d v)
+{
+  __m128d s = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+  return _mm_cvtsd_f64(_mm_add_sd(s, _mm_unpackhi_pd(s, s)));
+}
+
+#define FUNCTION dot_avx2_0
+#define COEF_INTERP 0
+#include "rate_poly_fir_vec.h"
+#define FUNCTION dot_avx2_1
+#define COEF_INTERP 1
+#include "rate_poly_fir_vec.h"
+#define FUNCTION dot_avx2_2
+#define COEF_INTERP 2
+#include "rate_poly_fir_vec.h"
+#define FUNCTION dot_avx2_3
+#define COEF_INTERP 3
+#include "rate_poly_fir_vec.h"
+
+#undef VEC_LEN
+#undef coef_t
+#undef vec_t
+#undef vec_zero
+#undef vec_set1
+#undef vec_load
+#undef vec_load_in
+#undef vec_add
+#undef vec_mul
+#undef vec_sum
+
+#define VEC_LEN         8
+#define coef_t          float
+#define vec_t           __m256
+#define vec_zero        _mm256_setzero_ps()
+#define vec_set1(x)     set1f_avx2(x)
+#define vec_load(p)     _mm256_loadu_ps(p)
+#define vec_load_in(p)  _mm256_insertf128_ps(_mm256_castps128_ps256( \
+    _mm256_cvtpd_ps(_mm256_loadu_pd(p))), _mm256_cvtpd_ps(_mm256_loadu_pd((p) + 4)), 1)
+#define vec_add         _mm256_add_ps
+#define vec_mul         _mm256_mul_ps
+#define vec_sum(v)      sumf_avx2(v)
+
+static TARGET __m256 set1f_avx2(double x)
+{
+  __m128 v = _mm256_cvtpd_ps(_mm256_set1_pd(x));
+  return _mm256_insertf128_ps(_mm256_castps128_ps256(v), v, 1);
+}
+
+static TARGET sample_t sumf_avx2(__m256 v)
+{
+  __m128 s = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+  s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+  return _mm_cvtss_f32(_mm_add_ss(s, _mm_shuffle_ps(s, s, 1)));
+}
+
+#define FUNCTION dotf_avx2_0
+#define COEF_INTERP 0
+#include "rate_poly_fir_vec.h"
+#define FUNCTION dotf_avx2_1
+#define COEF_INTERP 1
+#include "rate_poly_fir_vec.h"
+#define FUNCTION dotf_avx2_2
+#define COEF_INTERP 2
+#include "rate_poly_fir_vec.h"
+#define FUNCTION dotf_avx2_3
+#define COEF_INTERP 3
+#include "rate_poly_fir_vec.h"
+
+#undef TARGET
+#undef VEC_LEN
+#undef coef_t
+#undef vec_t
+#undef vec_zero
+#undef vec_set1
+#undef vec_load
+#undef vec_load_in
+#undef vec_add
+#undef vec_mul
+#undef vec_sum
+
+#endif
+
+#if defined HAVE_NEON_FIR
+
+#define TARGET
+
+#if defined __aarch64__
+
+#define VEC_LEN         2
+#define coef_t          double
+#define vec_t           float64x2_t
+#define vec_zero        vdupq_n_f64(0.)
+#define vec_set1(x)     vdupq_n_f64(x)
+#define vec_load(p)     vld1q_f64(p)
+#define vec_load_in(p)  vld1q_f64(p)
+#define vec_add         vaddq_f64
+#define vec_mul         vmulq_f64
+#define vec_sum(v)      vaddvq_f64(v)
+
+#define FUNCTION dot_neon_0
+#define COEF_INTERP 0
+#include "rate_poly_fir_vec.h"
+#define FUNCTION dot_neon_1
+#define COEF_INTERP 1
+#include "rate_poly_fir_vec.h"
+#define FUNCTION dot_neon_2
+#define COEF_INTERP 2
+#include "rate_poly_fir_vec.h"
+#define FUNCTION dot_neon_3
+#define COEF_INTERP 3
+#include "rate_poly_fir_vec.h"
+
+#undef VEC_LEN
+#undef coef_t
+#undef vec_t
+#undef vec_zero
+#undef vec_set1
+#undef vec_load
+#undef vec_load_in
+#undef vec_add
+#undef vec_mul
+#undef vec_sum
+
+static float32x4_t loadf_neon(sample_t const * p)
+{
+  return vcombine_f32(vcvt_f32_f64(vld1q_f64(p)), vcvt_f32_f64(vld1q_f64(p + 2)));
+}
+
+#define sumf_neon(v)    vaddvq_f32(v)
+
+#else
+
+static float32x4_t loadf_neon(sample_t const * p)
+{
+  float f[4];
+
+  f[0] = p[0], f[1] = p[1], f[2] = p[2], f[3] = p[3];
+  return vld1q_f32(f);
+}
+
+static sample_t sumf_neon(float32x4_t v)
+{
+  float32x2_t s = vadd_f32(vget_low_f32(v), vget_high_f32(v));
+  return vget_lane_f32(vpadd_f32(s, s), 0);
+}
+
+#endif
+
+static float32x4_t set1f_neon(double x)
+{
+  float f = x;
+  return vld1q_dup_f32(&f);
+}
+
+#define VEC_LEN         4
+#define coef_t          float
+#define vec_t           float32x4_t
+#define vec_zero        vdupq_n_f32(0.f)
+#define vec_set1(x)     set1f_neon(x)
+#define vec_load(p)     vld1q_f32(p)
+#define vec_load_in(p)  loadf_neon(p)
+#define vec_add         vaddq_f32
+#define vec_mul         vmulq_f32
+#define vec_sum(v)      sumf_neon(v)
+
+#define FUNCTION dotf_neon_0
+#define COEF_INTERP 0
+#include "rate_poly_fir_vec.h"
+#define FUNCTION dotf_neon_1
+#define COEF_INTERP 1
+#include "rate_poly_fir_vec.h"
+#define FUNCTION dotf_neon_2
+#define COEF_INTERP 2
+#include "rate_poly_fir_vec.h"
+#define FUNCTION dotf_neon_3
+#define COEF_INTERP 3
+#include "rate_poly_fir_vec.h"
+
+#undef TARGET
+#undef VEC_LEN
+#undef coef_t
+#undef vec_t
+#undef vec_zero
+#undef vec_set1
+#undef vec_load
+#undef vec_load_in
+#undef vec_add
+#undef vec_mul
+#undef vec_sum
+
+#endif
+
+/* The widest kernel for this CPU, or NULL to use the scalar code */
+static poly_fir_dot_t poly_fir_dot(int interp_order, sox_bool single)
+{
+#if defined HAVE_AVX2_FIR
+  static poly_fir_dot_t const avx2[] = POLY_FIR_DOTS(dot_avx2_);
+  static poly_fir_dot_t const avx2f[] = POLY_FIR_DOTS(dotf_avx2_);
+  if (lsx_have_avx2())
+    return single? avx2f[interp_order] : avx2[interp_order];
+#endif
+#if defined HAVE_SSE2_FIR
+  {
+    static poly_fir_dot_t const sse2[] = POLY_FIR_DOTS(dot_sse2_);
+    static poly_fir_dot_t const sse2f[] = POLY_FIR_DOTS(dotf_sse2_);
+    return single? sse2f[interp_order] : sse2[interp_order];
+  }
+#elif defined HAVE_NEON_FIR
+  {
+    static poly_fir_dot_t const neonf[] = POLY_FIR_DOTS(dotf_neon_);
+  #if defined __aarch64__
+    static poly_fir_dot_t const neon[] = POLY_FIR_DOTS(dot_neon_);
+    return single? neonf[interp_order] : neon[interp_order];
+  #else
+    return single? neonf[interp_order] : NULL;
+  #endif
+  }
+#else
+  (void)interp_order, (void)single;
+  return NULL;
+#endif
+}
+
+/* The widest kernel for a plain FIR */
+static poly_fir_dot_t fir_dot(void)
+{
+  poly_fir_dot_t dot = poly_fir_dot(0, sox_false);
+  return dot? dot : dot_0;
+}
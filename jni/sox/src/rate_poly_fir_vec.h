@@ -0,0 +1,67 @@
+/* Effect: change sample rate     Copyright (c) 2008 robs@users.sourceforge.net
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or (at
+ * your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/* One output sample of a poly-phase FIR: the dot product of len input samples
+ * with one phase's coefficients, each interpolated (to order COEF_INTERP) at
+ * x.  Vectorised with the vec_* macros of rate_poly_fir_simd.h; any taps left
+ * over from the vector width are done one at a time. */
+
+static TARGET sample_t FUNCTION(sample_t const * at, void const * coefs,
+    int len, sample_t x)
+{
+  coef_t const * c = coefs;   /* Rows of len coefs: highest order first */
+  vec_t sum = vec_zero, k;
+  sample_t tail = 0, kx;
+  int j = 0;
+#if COEF_INTERP > 0
+  vec_t vx = vec_set1(x);
+#endif
+
+  for (; j + VEC_LEN <= len; j += VEC_LEN) {
+    k = vec_load(c + j);
+#if COEF_INTERP > 0
+    k = vec_add(vec_mul(k, vx), vec_load(c + len + j));
+#endif
+#if COEF_INTERP > 1
+    k = vec_add(vec_mul(k, vx), vec_load(c + 2 * len + j));
+#endif
+#if COEF_INTERP > 2
+    k = vec_add(vec_mul(k, vx), vec_load(c + 3 * len + j));
+#endif
+    sum = vec_add(sum, vec_mul(k, vec_load_in(at + j)));
+  }
+  for (; j < len; ++j) {
+    kx = c[j];
+#if COEF_INTERP > 0
+    kx = kx * x + c[len + j];
+#endif
+#if COEF_INTERP > 1
+    kx = kx * x + c[2 * len + j];
+#endif
+#if COEF_INTERP > 2
+    kx = kx * x + c[3 * len + j];
+#endif
+    tail += kx * at[j];
+  }
+#if COEF_INTERP == 0
+  (void)x;
+#endif
+  return vec_sum(sum) + tail;
+}
+
+#undef COEF_INTERP
+#undef FUNCTION
@@ -72,12 +72,11 @@ int lsx_rawstart(sox_format_t * ft, sox_bool default_rate,
   { \
     size_t n, nread; \
     SOX_SAMPLE_LOCALS; \
-    ctype *data = lsx_malloc(sizeof(ctype) * len); \
+    ctype *data = lsx_scratch(ft, lsx_scratch_samples, sizeof(ctype) * len); \
     LSX_UNUSED_VAR(sox_macro_temp_sample), LSX_UNUSED_VAR(sox_macro_temp_double); \
     nread = lsx_read_ ## type ## _buf(ft, (uctype *)data, len); \
     for (n = 0; n < nread; n++) \
       *buf++ = cast(data[n], ft->clips); \
-    free(data); \
     return nread; \
   }
 
@@ -86,12 +85,9 @@ READ_SAMPLES_FUNC(b, 1, s, int8_t, uint8_t, SOX_SIGNED_8BIT_TO_SAMPLE)
 READ_SAMPLES_FUNC(b, 1, ulaw, uint8_t, uint8_t, SOX_ULAW_BYTE_TO_SAMPLE)
 READ_SAMPLES_FUNC(b, 1, alaw, uint8_t, uint8_t, SOX_ALAW_BYTE_TO_SAMPLE)
 READ_SAMPLES_FUNC(w, 2, u, uint16_t, uint16_t, SOX_UNSIGNED_16BIT_TO_SAMPLE)
-READ_SAMPLES_FUNC(w, 2, s, int16_t, uint16_t, SOX_SIGNED_16BIT_TO_SAMPLE)
 READ_SAMPLES_FUNC(3, 3, u, uint24_t, uint24_t, SOX_UNSIGNED_24BIT_TO_SAMPLE)
-READ_SAMPLES_FUNC(3, 3, s, int24_t, uint24_t, SOX_SIGNED_24BIT_TO_SAMPLE)
 READ_SAMPLES_FUNC(dw, 4, u, uint32_t, uint32_t, SOX_UNSIGNED_32BIT_TO_SAMPLE)
 READ_SAMPLES_FUNC(dw, 4, s, int32_t, uint32_t, SOX_SIGNED_32BIT_TO_SAMPLE)
-READ_SAMPLES_FUNC(f, sizeof(float), su, float, float, SOX_FLOAT_32BIT_TO_SAMPLE)
 READ_SAMPLES_FUNC(df, sizeof(double), su, double, double, SOX_FLOAT_64BIT_TO_SAMPLE)
 
 #define WRITE_SAMPLES_FUNC(type, size, sign, ctype, uctype, cast) \
@@ -100,12 +96,11 @@ READ_SAMPLES_FUNC(df, sizeof(double), su, double, double, SOX_FLOAT_64BIT_TO_SAM
   { \
     SOX_SAMPLE_LOCALS; \
     size_t n, nwritten; \
-    ctype *data = lsx_malloc(sizeof(ctype) * len); \
+    ctype *data = lsx_scratch(ft, lsx_scratch_samples, sizeof(ctype) * len); \
     LSX_UNUSED_VAR(sox_macro_temp_sample), LSX_UNUSED_VAR(sox_macro_temp_double); \
     for (n = 0; n < len; n++) \
       data[n] = cast(buf[n], ft->clips); \
     nwritten = lsx_write_ ## type ## _buf(ft, (uctype *)data, len); \
-    free(data); \
     return nwritten; \
   }
 
@@ -115,14 +110,67 @@ WRITE_SAMPLES_FUNC(b, 1, s, int8_t, uint8_t, SOX_SAMPLE_TO_SIGNED_8BIT)
 WRITE_SAMPLES_FUNC(b, 1, ulaw, uint8_t, uint8_t, SOX_SAMPLE_TO_ULAW_BYTE) 
 WRITE_SAMPLES_FUNC(b, 1, alaw, uint8_t, uint8_t, SOX_SAMPLE_TO_ALAW_BYTE)
 WRITE_SAMPLES_FUNC(w, 2, u, uint16_t, uint16_t, SOX_SAMPLE_TO_UNSIGNED_16BIT) 
-WRITE_SAMPLES_FUNC(w, 2, s, int16_t, uint16_t, SOX_SAMPLE_TO_SIGNED_16BIT)
 WRITE_SAMPLES_FUNC(3, 3, u, uint24_t, uint24_t, SOX_SAMPLE_TO_UNSIGNED_24BIT) 
-WRITE_SAMPLES_FUNC(3, 3, s, int24_t, uint24_t, SOX_SAMPLE_TO_SIGNED_24BIT)
 WRITE_SAMPLES_FUNC(dw, 4, u, uint32_t, uint32_t, SOX_SAMPLE_TO_UNSIGNED_32BIT) 
 WRITE_SAMPLES_FUNC(dw, 4, s, int32_t, uint32_t, SOX_SAMPLE_TO_SIGNED_32BIT)
-WRITE_SAMPLES_FUNC(f, sizeof(float), su, float, float, SOX_SAMPLE_TO_FLOAT_32BIT) 
 WRITE_SAMPLES_FUNC(df, sizeof (double), su, double, double, SOX_SAMPLE_TO_FLOAT_64BIT)
 
+/* The common encodings are converted a block at a time (see pcmconv.c) */
+
+#define SWAP_PCM(ft) (ft->encoding.reverse_bytes != SOX_OPTION_NO)
+#define BIG_ENDIAN_PCM(ft) (ft->encoding.reverse_bytes != MACHINE_IS_BIGENDIAN)
+
+static size_t sox_read_sw_samples(sox_format_t * ft, sox_sample_t *buf, size_t len)
+{
+  int16_t * data = lsx_scratch(ft, lsx_scratch_samples, sizeof(*data) * len);
+  size_t nread = lsx_readbuf(ft, data, sizeof(*data) * len) / sizeof(*data);
+
+  lsx_s16_to_samples(buf, data, nread, SWAP_PCM(ft));
+  return nread;
+}
+
+static size_t sox_write_sw_samples(sox_format_t * ft, sox_sample_t const * buf, size_t len)
+{
+  int16_t * data = lsx_scratch(ft, lsx_scratch_samples, sizeof(*data) * len);
+
+  ft->clips += lsx_samples_to_s16(data, buf, len, SWAP_PCM(ft));
+  return lsx_writebuf(ft, data, sizeof(*data) * len) / sizeof(*data);
+}
+
+static size_t sox_read_s3_samples(sox_format_t * ft, sox_sample_t *buf, size_t len)
+{
+  uint8_t * data = lsx_scratch(ft, lsx_scratch_samples, 3 * len);
+  size_t nread = lsx_readbuf(ft, data, 3 * len) / 3;
+
+  lsx_s24_to_samples(buf, data, nread, BIG_ENDIAN_PCM(ft));
+  return nread;
+}
+
+static size_t sox_write_s3_samples(sox_format_t * ft, sox_sample_t const * buf, size_t len)
+{
+  uint8_t * data = lsx_scratch(ft, lsx_scratch_samples, 3 * len);
+
+  ft->clips += lsx_samples_to_s24(data, buf, len, BIG_ENDIAN_PCM(ft));
+  return lsx_writebuf(ft, data, 3 * len) / 3;
+}
+
+static size_t sox_read_suf_samples(sox_format_t * ft, sox_sample_t *buf, size_t len)
+{
+  float * data = lsx_scratch(ft, lsx_scratch_samples, sizeof(*data) * len);
+  size_t nread = lsx_readbuf(ft, data, sizeof(*data) * len) / sizeof(*data);
+
+  ft->clips += lsx_f32_to_samples(buf, data, nread, SWAP_PCM(ft));
+  return nread;
+}
+
+static size_t sox_write_suf_samples(sox_format_t * ft, sox_sample_t const * buf, size_t len)
+{
+  float * data = lsx_scratch(ft, lsx_scratch_samples, sizeof(*data) * len);
+
+  ft->clips += lsx_samples_to_f32(data, buf, len, SWAP_PCM(ft));
+  return lsx_writebuf(ft, data, sizeof(*data) * len) / sizeof(*data);
+}
+
 #define GET_FORMAT(type) \
 static ft_##type##_fn * type##_fn(sox_format_t * ft) { \
   switch (ft->encoding.bits_per_sample) { \
@@ -191,6 +191,27 @@ static int getopts(sox_effect_t * effp, int argc, char **argv)
   return argc ? lsx_usage(effp) : SOX_SUCCESS;
 }
 
+static int flow_f(sox_effect_t * effp, const float * ibuf,
+                float * obuf, size_t * isamp, size_t * osamp)
+{
+  priv_t * p = (priv_t *)effp->priv;
+  size_t c, i, w, len = min(*isamp / p->ichannels, *osamp / p->ochannels);
+
+  *isamp = len * p->ichannels, *osamp = len * p->ochannels;
+  for (c = 0; c < p->ichannels; ++c)
+    p->chan[c].dry = fifo_write(&p->chan[c].reverb.input_fifo, len, 0);
+  for (i = 0; i < len; ++i) for (c = 0; c < p->ichannels; ++c)
+    p->chan[c].dry[i] = *ibuf++;
+  for (c = 0; c < p->ichannels; ++c)
+    reverb_process(&p->chan[c].reverb, len);
+  if (p->ichannels == 2) for (i = 0; i < len; ++i) for (w = 0; w < 2; ++w)
+    *obuf++ = (1 - p->wet_only) * p->chan[w].dry[i] +
+      .5 * (p->chan[0].wet[w][i] + p->chan[1].wet[w][i]);
+  else for (i = 0; i < len; ++i) for (w = 0; w < p->ochannels; ++w)
+    *obuf++ = (1 - p->wet_only) * p->chan[0].dry[i] + p->chan[0].wet[w][i];
+  return SOX_SUCCESS;
+}
+
 static int start(sox_effect_t * effp)
 {
   priv_t * p = (priv_t *)effp->priv;
@@ -215,6 +236,7 @@ static int start(sox_effect_t * effp)
 
   if (effp->in_signal.mult)
     *effp->in_signal.mult /= !p->wet_only + 2 * dB_to_linear(max(0,p->wet_gain_dB));
+  lsx_effect_set_float(effp, flow_f, NULL);
   return SOX_SUCCESS;
 }
 
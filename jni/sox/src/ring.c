@@ -0,0 +1,262 @@
+/* libSoX file format: bounded ring buffer for streaming to a consumer thread
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or (at
+ * your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/* The ring is a fixed-size single-producer/single-consumer byte queue.  The
+ * effects chain (producer) writes native-endian linear PCM into it through the
+ * `ring' format handler; the application (consumer) drains it with
+ * sox_ring_read.  Data transfer is lock-free: each side owns one free-running
+ * counter and only publishes it after the bytes it covers are in place.  The
+ * mutex and condition variable are used solely to put a side to sleep when the
+ * ring is full (producer) or empty (consumer), so neither side ever spins and
+ * memory use is independent of the length of the audio. */
+
+#include "sox_i.h"
+
+#ifdef HAVE_PTHREAD_H
+
+#include <pthread.h>
+#include <string.h>
+
+#define barrier() __sync_synchronize()
+
+struct sox_ring {
+  char            * buf;
+  size_t          size;       /* Power of 2 */
+  size_t volatile head;       /* Total bytes written; owned by producer */
+  size_t volatile tail;       /* Total bytes read; owned by consumer */
+  int    volatile eof;        /* Producer will write no more */
+  int    volatile aborted;    /* Consumer will read no more */
+  int    volatile waiters;
+  pthread_mutex_t lock;
+  pthread_cond_t  cond;
+};
+
+sox_ring_t * sox_ring_create(size_t size)
+{
+  sox_ring_t * r = lsx_calloc(1, sizeof(*r));
+
+  for (r->size = 256; r->size < size; r->size <<= 1);
+  r->buf = lsx_malloc(r->size);
+  pthread_mutex_init(&r->lock, NULL);
+  pthread_cond_init(&r->cond, NULL);
+  return r;
+}
+
+void sox_ring_delete(sox_ring_t * r)
+{
+  if (r) {
+    pthread_cond_destroy(&r->cond);
+    pthread_mutex_destroy(&r->lock);
+    free(r->buf);
+    free(r);
+  }
+}
+
+static void wake(sox_ring_t * r)
+{
+  barrier(); /* Publish our counter/flag before looking for sleepers */
+  if (r->waiters) {
+    pthread_mutex_lock(&r->lock);
+    pthread_cond_broadcast(&r->cond);
+    pthread_mutex_unlock(&r->lock);
+  }
+}
+
+/* Sleep until the predicate becomes true.  Registering as a waiter before
+ * re-checking (with a full barrier in between) pairs with wake() above, so a
+ * wake-up cannot be lost between the check and pthread_cond_wait. */
+#define WAIT_UNTIL(r, predicate) do { \
+  pthread_mutex_lock(&(r)->lock); \
+  ++(r)->waiters; \
+  barrier(); \
+  while (!(predicate)) \
+    pthread_cond_wait(&(r)->cond, &(r)->lock); \
+  --(r)->waiters; \
+  pthread_mutex_unlock(&(r)->lock); \
+} while (0)
+
+size_t sox_ring_fill(sox_ring_t * r)
+{
+  barrier();
+  return r->head - r->tail;
+}
+
+size_t sox_ring_read(sox_ring_t * r, void * buf, size_t len)
+{
+  size_t done = 0;
+
+  WAIT_UNTIL(r, r->head != r->tail || r->eof || r->aborted);
+  while (done < len && !r->aborted) {
+    size_t tail = r->tail, head, n, pos, n1;
+
+    barrier(); /* Order against the eof flag seen above */
+    head = r->head;
+    barrier(); /* Don't read bytes before seeing the head that covers them */
+    if (!(n = min(len - done, head - tail)))
+      break;
+    pos = tail & (r->size - 1), n1 = min(n, r->size - pos);
+    memcpy((char *)buf + done, r->buf + pos, n1);
+    memcpy((char *)buf + done + n1, r->buf, n - n1);
+    done += n;
+    r->tail = tail + n;
+    wake(r);
+  }
+  return done;
+}
+
+void * sox_ring_buffer(sox_ring_t * r, size_t * size)
+{
+  *size = r->size;
+  return r->buf;
+}
+
+size_t sox_ring_peek(sox_ring_t * r, size_t * offset)
+{
+  size_t tail = r->tail, head;
+
+  WAIT_UNTIL(r, r->head != r->tail || r->eof || r->aborted);
+  if (r->aborted)
+    return 0;
+  barrier(); /* Order against the eof flag seen above */
+  head = r->head;
+  barrier(); /* Don't read bytes before seeing the head that covers them */
+  *offset = tail & (r->size - 1);
+  return min(head - tail, r->size - *offset);
+}
+
+void sox_ring_consume(sox_ring_t * r, size_t len)
+{
+  barrier(); /* Finish with the bytes before handing them back */
+  r->tail += len;
+  wake(r);
+}
+
+void sox_ring_abort(sox_ring_t * r)
+{
+  r->aborted = 1;
+  wake(r);
+}
+
+/* Write all of buf, sleeping while the ring is full; returns less than len
+ * only if the reader has aborted */
+size_t lsx_ring_write(sox_ring_t * r, void const * buf, size_t len)
+{
+  size_t done = 0;
+
+  while (done < len) {
+    size_t head = r->head, n, pos, n1;
+
+    WAIT_UNTIL(r, head - r->tail < r->size || r->aborted);
+    if (r->aborted)
+      break;
+    barrier(); /* Don't overwrite bytes before seeing the tail that frees them */
+    n = min(len - done, r->size - (head - r->tail));
+    pos = head & (r->size - 1), n1 = min(n, r->size - pos);
+    memcpy(r->buf + pos, (char const *)buf + done, n1);
+    memcpy(r->buf, (char const *)buf + done + n1, n - n1);
+    done += n;
+    barrier(); /* Bytes must be visible before the head that covers them */
+    r->head = head + n;
+    wake(r);
+  }
+  return done;
+}
+
+typedef struct {
+  sox_ring_t   * ring;
+  size_t       buf_len;   /* In samples */
+  char         * buf;
+} priv_t;
+
+static int startwrite(sox_format_t * ft)
+{
+  priv_t * p = (priv_t *)ft->priv;
+
+  p->buf_len = sox_globals.bufsiz;
+  p->buf = lsx_malloc(p->buf_len * (ft->encoding.bits_per_sample >> 3));
+  return SOX_SUCCESS;
+}
+
+static size_t write_samples(
+    sox_format_t * ft, sox_sample_t const * buf, size_t len)
+{
+  priv_t * p = (priv_t *)ft->priv;
+  size_t bytes = ft->encoding.bits_per_sample >> 3, done = 0, n;
+
+  if (!p->ring) {
+    lsx_fail_errno(ft, SOX_EINVAL, "no ring attached");
+    return 0;
+  }
+  while (done < len) {
+    n = min(len - done, p->buf_len);
+    if (bytes == 2)
+      ft->clips += lsx_samples_to_s16((int16_t *)p->buf, buf + done, n, sox_false);
+    else memcpy(p->buf, buf + done, n * bytes);
+    if (lsx_ring_write(p->ring, p->buf, n * bytes) != n * bytes) {
+      lsx_fail_errno(ft, SOX_EPERM, "ring reader has gone away");
+      return done;
+    }
+    done += n;
+  }
+  return done;
+}
+
+/* Tell the reader that nothing more will be written */
+void lsx_ring_close(sox_ring_t * r)
+{
+  r->eof = 1;
+  wake(r);
+}
+
+static int stopwrite(sox_format_t * ft)
+{
+  priv_t * p = (priv_t *)ft->priv;
+
+  if (p->ring)
+    lsx_ring_close(p->ring);
+  free(p->buf);
+  return SOX_SUCCESS;
+}
+
+sox_format_t * sox_open_ring_write(
+    sox_ring_t               * ring,
+    sox_signalinfo_t   const * signal,
+    sox_encodinginfo_t const * encoding,
+    sox_oob_t          const * oob)
+{
+  sox_format_t * ft = sox_open_write("", signal, encoding, "ring", oob, NULL);
+
+  if (ft)
+    ((priv_t *)ft->priv)->ring = ring;
+  return ft;
+}
+
+LSX_FORMAT_HANDLER(ring)
+{
+  static char const * const names[] = {"ring", NULL};
+  static unsigned const write_encodings[] = {
+    SOX_ENCODING_SIGN2, 16, 32, 0, 0};
+  static sox_format_handler_t const handler = {SOX_LIB_VERSION_CODE,
+    "Stream native-endian PCM to a bounded in-memory ring",
+    names, SOX_FILE_DEVICE | SOX_FILE_PHONY | SOX_FILE_NOSTDIO,
+    NULL, NULL, NULL, startwrite, write_samples, stopwrite,
+    NULL, write_encodings, NULL, sizeof(priv_t)
+  };
+  return &handler;
+}
+
+#endif
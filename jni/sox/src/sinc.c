@@ -99,9 +99,12 @@ static int start(sox_effect_t * effp)
 {
   priv_t * p = (priv_t *)effp->priv;
   dft_filter_t * f = p->base.filter_ptr;
+  double Fn = effp->in_signal.rate * .5;
+  double key[] = {Fn, p->Fc0, p->Fc1, p->tbw0, p->tbw1, p->num_taps[0],
+      p->num_taps[1], p->att, p->beta, p->phase, p->round};
 
-  if (!f->num_taps) {
-    double Fn = effp->in_signal.rate * .5;
+  if (!f->num_taps && (effp->global_info->plot != sox_plot_off ||
+        !lsx_find_filter(f, "sinc", key, (int)array_length(key)))) {
     double * h[2];
     int i, n, post_peak, longer;
 
@@ -138,6 +141,7 @@ static int start(sox_effect_t * effp)
       return SOX_EOF;
     }
     lsx_set_dft_filter(f, h[longer], n, post_peak);
+    lsx_cache_filter(f, "sinc", key, (int)array_length(key), (size_t)f->dft_length);
   }
   return lsx_dft_filter_effect_fn()->start(effp);
 }
@@ -124,6 +124,7 @@ static enum { sox_single, sox_multiple } output_method = sox_single;
 #define is_parallel(m) (!is_serial(m))
 static sox_bool no_clobber = sox_false, interactive = sox_false;
 static sox_bool uservolume = sox_false;
+static sox_bool fuse_biquads = sox_false, use_float = sox_false;
 typedef enum {RG_off, RG_track, RG_album, RG_default} rg_mode;
 static lsx_enum_item const rg_modes[] = {
   LSX_ENUM_ITEM(RG_,off)
@@ -1634,9 +1635,12 @@ static int process(void)
   calculate_output_signal_parameters();
   open_output_file();
 
-  if (!effects_chain)
+  if (!effects_chain) {
     effects_chain = sox_create_effects_chain(&combiner_encoding,
                                              &ofile->ft->encoding);
+    effects_chain->fuse_biquads = fuse_biquads;
+    effects_chain->use_float = use_float;
+  }
   add_effects(effects_chain);
 
   optimize_trim();
@@ -1659,7 +1663,9 @@ static int process(void)
 
   signal(SIGTERM, sigint); /* Stop gracefully, as soon as we possibly can. */
   signal(SIGINT , sigint); /* Either skip current input or behave as SIGTERM. */
-  flow_status = sox_flow_effects(effects_chain, update_status, NULL);
+  flow_status = single_threaded?
+    sox_flow_effects(effects_chain, update_status, NULL) :
+    sox_pipeline_effects(effects_chain, update_status, NULL);
 
   /* Don't return SOX_EOF if
    * 1) input reach EOF and there are more input files to process or
@@ -1797,19 +1803,30 @@ static void usage(char const * message)
 "--combine sequence       Sequence all input files (default for play)",
 "-D, --no-dither          Don't dither automatically",
 "--effects-file FILENAME  File containing effects and options",
+"--filter-block SAMPLES   Process long FIR filters (fir, sinc, loudness, ...)",
+"                         in partitions of at most SAMPLES, to bound their",
+"                         latency; has no effect on rate",
+"--flac-threads N         Encode FLAC output using N threads",
+"--float                  Pass audio between effects that support it (e.g.",
+"                         rate, tempo, vol) as unclipped 32-bit floats",
+"--fuse-biquads           Run consecutive biquad-type effects (bass, treble,",
+"                         equalizer, ...) as one, faster effect; output is not",
+"                         clipped between them",
 "-G, --guard              Use temporary files to guard against clipping",
 "-h, --help               Display version number and usage information",
 "--help-effect NAME       Show usage of effect NAME, or NAME=all for all",
 "--help-format NAME       Show info on format NAME, or NAME=all for all",
 "--i, --info              Behave as soxi(1)",
 "--input-buffer BYTES     Override the input buffer size (default: as --buffer)",
+"--mp3-index DIR          Keep MP3 seek indexes in DIR (\"\" for beside the",
+"                         MP3 files), for quicker seeking in VBR files",
 "--no-clobber             Prompt to overwrite output file",
 "-m, --combine mix        Mix multiple input files (instead of concatenating)",
 "--combine mix-power      Mix to equal power (instead of concatenating)",
 "-M, --combine merge      Merge multiple input files (instead of concatenating)",
 "--magic                  Use `magic' file-type detection",
-"--multi-threaded         Enable parallel effects channels processing (where",
-"                         available)",
+"--multi-threaded         Enable parallel effects channels processing, and run",
+"                         each effect on its own thread (where available)",
 "--norm                   Guard (see --guard) & normalise",
 "--play-rate-arg ARG      Default `rate' argument for auto-resample with `play'",
 "--plot gnuplot|octave    Generate script to plot response of filter effect",
@@ -2040,6 +2057,11 @@ static struct option const long_options[] = {
   {"clobber"         ,       no_argument, NULL, 0},
   {"no-clobber"      ,       no_argument, NULL, 0},
   {"multi-threaded"  ,       no_argument, NULL, 0},
+  {"filter-block"    , required_argument, NULL, 0},
+  {"mp3-index"       , required_argument, NULL, 0},
+  {"flac-threads"    , required_argument, NULL, 0},
+  {"fuse-biquads"    ,       no_argument, NULL, 0},
+  {"float"           ,       no_argument, NULL, 0},
 
   {"bits"            , required_argument, NULL, 'b'},
   {"channels"        , required_argument, NULL, 'c'},
@@ -2150,7 +2172,6 @@ static char parse_gopts_and_fopts(file_t * f, int argc, char **argv)
         break;
 
       case 1:
-#define SOX_BUFMIN 16
         if (sscanf(lsx_optarg, "%i %c", &i, &dummy) != 1 || i <= SOX_BUFMIN) {
           lsx_fail("Buffer size `%s' must be > %d", lsx_optarg, SOX_BUFMIN);
           exit(1);
@@ -2215,6 +2236,27 @@ static char parse_gopts_and_fopts(file_t * f, int argc, char **argv)
       case 22: no_clobber = sox_false; break;
       case 23: no_clobber = sox_true; break;
       case 24: single_threaded = sox_false; break;
+
+      case 25:
+        if (sscanf(lsx_optarg, "%i %c", &i, &dummy) != 1 || i < SOX_BUFMIN) {
+          lsx_fail("Filter block `%s' must be >= %d", lsx_optarg, SOX_BUFMIN);
+          exit(1);
+        }
+        sox_globals.filter_block = i;
+        break;
+
+      case 26: sox_globals.mp3_index_dir = strdup(lsx_optarg); break;
+
+      case 27:
+        if (sscanf(lsx_optarg, "%i %c", &i, &dummy) != 1 || i < 1) {
+          lsx_fail("FLAC threads `%s' must be >= 1", lsx_optarg);
+          exit(1);
+        }
+        sox_globals.flac_threads = i;
+        break;
+
+      case 28: fuse_biquads = sox_true; break;
+      case 29: use_float = sox_true; break;
       }
       break;
 
@@ -169,6 +169,7 @@ typedef int32_t sox_sample_t;
 
 
 #define SOX_SIZE_MAX ((size_t)(-1))
+#define SOX_BUFMIN 16 /* Least sample-buffer and filter-block size */
 
 typedef void (*sox_output_message_handler_t)(unsigned level, const char *filename, const char *fmt, va_list ap);
 
@@ -183,6 +184,23 @@ typedef struct { /* Global parameters (for effects & formats) */
  */
   size_t       bufsiz, input_bufsiz;
   int32_t      ranqd1; /* Can be used to re-seed libSoX's PRNG */
+/* Designed filters that are no longer in use are kept for re-use by later
+ * effects until they occupy more than this many bytes; 0 disables this. */
+  size_t       filter_cache_size;
+/* If nonzero, FIR filter effects (sinc, fir, etc., but not rate) process
+ * long filters in partitions, adding no more than this many samples (at
+ * least SOX_BUFMIN) of latency. */
+  size_t       filter_block;
+/* If not NULL, the frame offsets found while reading an MP3 file are kept in
+ * this directory (or if it is "", beside the file) for quick seeking when the
+ * file is next read. */
+  char const * mp3_index_dir;
+/* If set, seeks in MP3 files beyond the frames indexed so far use the file's
+ * Xing or VBRI table of contents; this is quick, but not sample-accurate. */
+  sox_bool     mp3_toc_seek;
+/* If greater than 1, FLAC files are written using this many threads, each
+ * encoding whole frames; the output is the same as with one. */
+  unsigned     flac_threads;
 
 /* private: */
   char const * stdin_in_use_by;
@@ -381,6 +399,8 @@ struct sox_format {
   long             data_start;
   sox_format_handler_t handler;     /* Format handler for this file */
   void             * priv;          /* Format handler's private data area */
+  void             * scratch[2];    /* Reusable work areas; see lsx_scratch */
+  size_t           scratch_size[2];
 };
 
 /* File flags field */
@@ -455,6 +475,32 @@ sox_format_t * sox_open_memstream_write(
     sox_encodinginfo_t const * encoding,
     char               const * filetype,
     sox_oob_t          const * oob);
+
+/* Bounded single-producer/single-consumer PCM ring (requires pthreads).
+ * An effects chain writes into it through sox_open_ring_write; another thread
+ * drains it with sox_ring_read, which blocks until data is available and
+ * returns 0 once the writer has been closed and the ring is empty.  The
+ * writer blocks while the ring is full, so memory use stays constant.
+ * sox_ring_abort makes both sides return early (the chain then stops with a
+ * write error).  Ring size is in bytes and is rounded up to a power of 2.
+ * To read without copying, sox_ring_peek waits as sox_ring_read does, then
+ * gives the offset into sox_ring_buffer of the bytes that can be read there
+ * in one piece; they stay in place until passed to sox_ring_consume. */
+typedef struct sox_ring sox_ring_t;
+sox_ring_t * sox_ring_create(size_t size);
+void sox_ring_delete(sox_ring_t * ring);
+size_t sox_ring_read(sox_ring_t * ring, void * buf, size_t len);
+void * sox_ring_buffer(sox_ring_t * ring, size_t * size);
+size_t sox_ring_peek(sox_ring_t * ring, size_t * offset);
+void sox_ring_consume(sox_ring_t * ring, size_t len);
+size_t sox_ring_fill(sox_ring_t * ring);
+void sox_ring_abort(sox_ring_t * ring);
+sox_format_t * sox_open_ring_write(
+    sox_ring_t               * ring,
+    sox_signalinfo_t   const * signal,
+    sox_encodinginfo_t const * encoding,
+    sox_oob_t          const * oob);
+
 size_t sox_read(sox_format_t * ft, sox_sample_t *buf, size_t len);
 size_t sox_write(sox_format_t * ft, const sox_sample_t *buf, size_t len);
 int sox_close(sox_format_t * ft);
@@ -520,6 +566,18 @@ struct sox_effect {
   size_t               flows;         /* 1 if MCHAN, # chans otherwise */
   size_t               flow;          /* flow # */
   void                     * priv;        /* Effect's private data area */
+  /* Native float flow & drain, if offered by start() (see
+   * lsx_effect_set_float) and the chain has use_float set: */
+  int (*flow_f)(sox_effect_t * effp, const float *ibuf,
+      float *obuf, size_t *isamp, size_t *osamp);
+  int (*drain_f)(sox_effect_t * effp, float *obuf, size_t *osamp);
+  sox_bool             flow_float;    /* obuf holds floats; uses flow_f */
+  /* Changes parameters while running, if offered by start() (see
+   * lsx_effect_set_param and sox_effects_set_param): */
+  int (*set_param)(sox_effect_t * effp, char const * name, double value,
+      double * speed);
+  sox_bool             adjustable;    /* Copied from the chain before start() */
+  size_t               step;          /* Rounds of flows run (first flow's) */
 };
 
 sox_effect_handler_t const * sox_find_effect(char const * name);
@@ -538,6 +596,11 @@ struct sox_effects_chain {
   sox_effects_globals_t global_info;
   sox_encodinginfo_t const * in_enc;
   sox_encodinginfo_t const * out_enc;
+  struct sox_flow_state * flow; /* Used by sox_render_effects */
+  sox_bool use_float; /* Set before adding effects to run float effects natively */
+  sox_bool adjustable; /* Set before adding effects to change them while running */
+  sox_bool fuse_biquads; /* Set before adding effects to run consecutive biquads
+                          * as one effect, unclipped between them */
 };
 typedef struct sox_effects_chain sox_effects_chain_t;
 sox_effects_chain_t * sox_create_effects_chain(
@@ -545,7 +608,25 @@ sox_effects_chain_t * sox_create_effects_chain(
 void sox_delete_effects_chain(sox_effects_chain_t *ecp);
 int sox_add_effect( sox_effects_chain_t * chain, sox_effect_t * effp, sox_signalinfo_t * in, sox_signalinfo_t const * out);
 int sox_flow_effects(sox_effects_chain_t *, int (* callback)(sox_bool all_done, void * client_data), void * client_data);
+size_t sox_render_effects(sox_effects_chain_t * chain, sox_sample_t * obuf, size_t frames);
+int sox_render_status(sox_effects_chain_t * chain);
+int sox_pipeline_effects(sox_effects_chain_t *, int (* callback)(sox_bool all_done, void * client_data), void * client_data);
 size_t sox_effects_clips(sox_effects_chain_t *);
+/* Changes a parameter of every effect with the given name in the chain,
+ * without stopping it; may be called from any one thread while the chain
+ * runs (or from the same thread, between calls of sox_render_effects).  Each
+ * effect takes up the new value at its next processing boundary and moves to
+ * it smoothly.  The chain should have adjustable set, so that effects that
+ * start as no-ops are kept, and rate is ready to change.  This costs rate
+ * some speed: it always runs a poly-phase stage, doubling the rate first if
+ * the factor is below 2, and -l quality is raised to -m.  Parameters are:
+ *   tempo: factor    pitch: cents    speed: factor    vol: gain (amplitude)
+ *   rate: speed (ratio of actual to configured input rate; usually set
+ *         through pitch or speed, whose output it resamples)
+ * Returns SOX_SUCCESS, SOX_EOF if there is no such effect, or SOX_EINVAL if
+ * the parameter or value is not supported (nothing is then changed). */
+int sox_effects_set_param(sox_effects_chain_t * chain, char const * effect,
+    char const * name, double value);
 size_t sox_stop_effect(sox_effect_t *effp);
 void sox_push_effect_last(sox_effects_chain_t *chain, sox_effect_t *effp);
 sox_effect_t *sox_pop_effect_last(sox_effects_chain_t *chain);
@@ -92,8 +92,14 @@ double lsx_bessel_I_0(double x);
 int lsx_set_dft_length(int num_taps);
 void init_fft_cache(void);
 void clear_fft_cache(void);
+void init_filter_cache(void);  /* Implemented in dft_filter.c */
+void clear_filter_cache(void);
 void lsx_safe_rdft(int len, int type, double * d);
 void lsx_safe_cdft(int len, int type, double * d);
+typedef struct lsx_rdft_plan lsx_rdft_plan_t; /* Free with free() */
+lsx_rdft_plan_t * lsx_rdft_plan(int len);
+int lsx_rdft_work_len(lsx_rdft_plan_t const * plan);
+void lsx_rdft_any(lsx_rdft_plan_t const * plan, double * d, double * work);
 void lsx_power_spectrum(int n, double const * in, double * out);
 void lsx_power_spectrum_f(int n, float const * in, float * out);
 void lsx_apply_hann_f(float h[], const int num_points);
@@ -147,6 +153,13 @@ int lsx_writes(sox_format_t * ft, char const * c);
 void lsx_set_signal_defaults(sox_format_t * ft);
 #define lsx_writechars(ft, chars, len) (lsx_writebuf(ft, chars, len) == len? SOX_SUCCESS : SOX_EOF)
 
+/* Per-file work areas that persist between calls, so that read and write
+ * functions needn't allocate on every call.  Each may be in use by only one
+ * caller at a time: lsx_scratch_samples by format handlers (e.g. for sample
+ * conversion), lsx_scratch_bytes by the lsx_read/write_xxx_buf functions. */
+typedef enum {lsx_scratch_samples, lsx_scratch_bytes} lsx_scratch_t;
+void * lsx_scratch(sox_format_t * ft, lsx_scratch_t which, size_t size);
+
 size_t lsx_read_3_buf(sox_format_t * ft, uint24_t *buf, size_t len);
 size_t lsx_read_b_buf(sox_format_t * ft, uint8_t *buf, size_t len);
 size_t lsx_read_df_buf(sox_format_t * ft, double *buf, size_t len);
@@ -218,6 +231,33 @@ typedef struct sox_formats_globals { /* Global parameters (for formats) */
 
 
 
+/* Where the compiler can build single functions for AVX2 (declared with
+ * LSX_AVX2), they may be called only if lsx_have_avx2(); implemented in
+ * util.c */
+#if (defined __x86_64__ || defined __i386__) && (defined __clang__ || \
+    __GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+  #define LSX_AVX2 __attribute__((target("avx2")))
+  sox_bool lsx_have_avx2(void);
+#endif
+
+/*------------------------ Implemented in pcmconv.c --------------------------*/
+
+/* Block conversions for the common linear PCM encodings; swap means the PCM
+ * is not in host byte order.  Those from sox_sample_t return the number of
+ * samples clipped, as do those from float. */
+void lsx_s16_to_samples(sox_sample_t * dst, int16_t const * src, size_t len, sox_bool swap);
+size_t lsx_samples_to_s16(int16_t * dst, sox_sample_t const * src, size_t len, sox_bool swap);
+void lsx_s24_to_samples(sox_sample_t * dst, uint8_t const * src, size_t len, sox_bool big_endian);
+size_t lsx_samples_to_s24(uint8_t * dst, sox_sample_t const * src, size_t len, sox_bool big_endian);
+size_t lsx_f32_to_samples(sox_sample_t * dst, float const * src, size_t len, sox_bool swap);
+size_t lsx_samples_to_f32(float * dst, sox_sample_t const * src, size_t len, sox_bool swap);
+/* Interleave len frames from src[channel][], as from decoders that give
+ * planar output; integers are right-justified in the given number of bits. */
+void lsx_s32_planar_to_samples(sox_sample_t * dst, int32_t const * const * src, size_t len, unsigned channels, unsigned bits);
+size_t lsx_f32_planar_to_samples(sox_sample_t * dst, float const * const * src, size_t len, unsigned channels);
+
+
+
 /*------------------------------ File Handlers -------------------------------*/
 
 int lsx_check_read_params(sox_format_t * ft, unsigned channels,
@@ -292,6 +332,31 @@ char * lsx_usage_lines(char * * usage, char const * const * lines, size_t n);
 }
 
 int lsx_effect_set_imin(sox_effect_t * effp, size_t imin);
+void lsx_effect_set_float(sox_effect_t * effp,
+    int (*flow_f)(sox_effect_t *, const float *, float *, size_t *, size_t *),
+    int (*drain_f)(sox_effect_t *, float *, size_t *));
+void lsx_effect_set_param(sox_effect_t * effp,
+    int (*set_param)(sox_effect_t *, char const *, double, double *));
+
+/* A parameter value handed from a control thread to an effect's flows; one
+ * of these goes in the effect's priv, and is set only in the first flow's */
+typedef struct {
+  double            value;
+  unsigned volatile seq;   /* Odd while value is being written */
+  size_t            step;  /* First flow's: effect step when last taken */
+  unsigned          taken_seq; /* First flow's: seq of the value taken */
+  double            taken; /* First flow's: the value taken */
+  unsigned          seen;  /* taken_seq when last got; owned by the flow */
+} lsx_param_t;
+void lsx_param_set(lsx_param_t * p, double value);
+sox_bool lsx_param_get(sox_effect_t * effp, lsx_param_t * p, double * value);
+
+/* biquad.c, for sox_add_effect */
+void lsx_biquad_fuse(sox_effects_chain_t * chain);
+
+/* ring.c, also used to link the stages of sox_pipeline_effects */
+size_t lsx_ring_write(sox_ring_t * r, void const * buf, size_t len);
+void lsx_ring_close(sox_ring_t * r);
 
 int lsx_effects_init(void);
 int lsx_effects_quit(void);
@@ -181,6 +181,9 @@
 /* Define to 1 if you have the `popen' function. */
 #define HAVE_POPEN 1
 
+/* Define to 1 if you have the <pthread.h> header file. */
+#define HAVE_PTHREAD_H 1
+
 /* Define to 1 if you have pulseaudio. */
 /* #undef HAVE_PULSEAUDIO */
 
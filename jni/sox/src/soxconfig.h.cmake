@@ -34,6 +34,7 @@
 #cmakedefine HAVE_OSS                 1
 #cmakedefine HAVE_PNG                 1
 #cmakedefine HAVE_POPEN               1
+#cmakedefine HAVE_PTHREAD_H           1
 #cmakedefine HAVE_PULSEAUDIO          1
 #cmakedefine HAVE_SNDFILE             1
 #cmakedefine HAVE_SNDFILE_1_0_12      1
@@ -32,7 +32,7 @@
 #include <zlib.h>
 
 #define MAX_FFT_SIZE 4096
-#define is_p2(x) !(x & (x - 1))
+#define MAX_FRAMES 16      /* Windowed frames collected to transform together */
 
 typedef enum {Window_Hann, Window_Hamming, Window_Bartlett, Window_Rectangular, Window_Kaiser} win_type_t;
 static lsx_enum_item const window_options[] = {
@@ -47,23 +47,30 @@ typedef struct {
   /* Parameters */
   double     pixels_per_sec, duration, start_time,  window_adjust;
   int        x_size0, y_size, Y_size, dB_range, gain, spectrum_points, perm;
+  int        tile_cols;
   sox_bool   monochrome, light_background, high_colour, slack_overlap, no_axes;
   sox_bool   raw, alt_palette, truncate;
   win_type_t win_type;
   char const * out_name, * title, * comment;
 
   /* Shared work area */
-  double     * shared, * * shared_ptr;
+  lsx_rdft_plan_t * shared, * * shared_ptr;
+  int        flowed, * flowed_ptr; /* Flows done with the current input */
 
   /* Per-channel work area */
   int        WORK;  /* Start of work area is marked by this dummy variable. */
   size_t     skip;
   int        dft_size, step_size, block_steps, block_num, rows, cols, read;
-  int        x_size, end, end_min, last_end;
+  int        x_size, end, end_min, last_end, num_frames;
   sox_bool   truncated;
-  double     buf[MAX_FFT_SIZE], dft_buf[MAX_FFT_SIZE], window[MAX_FFT_SIZE];
+  double     buf[MAX_FFT_SIZE], window[MAX_FFT_SIZE], * frames, * dft_work;
   double     block_norm, max, magnitudes[(MAX_FFT_SIZE>>1) + 1];
-  float      * dBfs;
+  png_byte   * columns;     /* Ring of capacity columns, as palette indices */
+  int        capacity;
+
+  /* Tiles (channel 0's are used) */
+  int        cols_written, tile_num;
+  FILE       * index;
 } priv_t;
 
 #define secs(cols) \
@@ -100,8 +107,9 @@ static int getopts(sox_effect_t * effp, int argc, char **argv)
   p->dB_range = 120, p->spectrum_points = 249, p->perm = 1; /* Non-0 defaults */
   p->out_name = "spectrogram.png", p->comment = "Created by SoX";
 
-  while ((c = lsx_getopt(argc, argv, "+S:d:x:X:y:Y:z:Z:q:p:W:w:st:c:AarmlhTo:")) != -1) switch (c) {
+  while ((c = lsx_getopt(argc, argv, "+S:d:x:X:y:Y:z:Z:q:p:W:w:st:c:AarmlhTo:b:")) != -1) switch (c) {
     GETOPT_NUMERIC('x', x_size0       , 100, 5000)
+    GETOPT_NUMERIC('b', tile_cols     , 100, 5000)
     GETOPT_NUMERIC('X', pixels_per_sec,  1 , 5000)
     GETOPT_NUMERIC('y', y_size        , 64 , 1200)
     GETOPT_NUMERIC('Y', Y_size        , 130, MAX_FFT_SIZE / 2 + 2)
@@ -144,6 +152,7 @@ static int getopts(sox_effect_t * effp, int argc, char **argv)
   if (p->alt_palette)
     p->spectrum_points = min(p->spectrum_points, (int)alt_palette_len);
   p->shared_ptr = &p->shared;
+  p->flowed_ptr = &p->flowed;
   return lsx_optind !=argc || p->win_type == INT_MAX? lsx_usage(effp) : SOX_SUCCESS;
 }
 
@@ -168,27 +177,6 @@ static double make_window(priv_t * p, int end)
   return sum;
 }
 
-static double * rdft_init(int n)
-{
-  double * q = lsx_malloc(2 * (n / 2 + 1) * n * sizeof(*q)), * p = q;
-  int i, j;
-  for (j = 0; j <= n / 2; ++j) for (i = 0; i < n; ++i)
-    *p++ = cos(2 * M_PI * j * i / n), *p++ = sin(2 * M_PI * j * i / n);
-  return q;
-}
-
-#define _ re += in[i] * *q++, im += in[i++] * *q++,
-static void rdft_p(double const * q, double const * in, double * out, int n)
-{
-  int i, j;
-  for (j = 0; j <= n / 2; ++j) {
-    double re = 0, im = 0;
-    for (i = 0; i < (n & ~7);) _ _ _ _ _ _ _ _ 0;
-    while (i < n) _ 0;
-    *out++ += re * re + im * im;
-  }
-}
-
 static int start(sox_effect_t * effp)
 {
   priv_t * p = (priv_t *)effp->priv;
@@ -202,14 +190,14 @@ static int start(sox_effect_t * effp)
     if (!pixels_per_sec && p->x_size && duration)
       pixels_per_sec = min(5000, p->x_size / duration);
     else if (!p->x_size && pixels_per_sec && duration)
-      p->x_size = min(5000, (int)(pixels_per_sec * duration + .5));
+      p->x_size = (int)min(p->tile_cols? INT_MAX : 5000., pixels_per_sec * duration + .5);
     if (!duration && effp->in_signal.length) {
       duration = effp->in_signal.length / (effp->in_signal.rate * effp->in_signal.channels);
       duration -= p->start_time;
       if (duration <= 0)
         duration = 1;
       continue;
-    } else if (!p->x_size) {
+    } else if (!p->x_size && !p->tile_cols) {
       p->x_size = 800;
       continue;
     } else if (!pixels_per_sec) {
@@ -218,17 +206,19 @@ static int start(sox_effect_t * effp)
     }
     break;
   }
+  if (!p->x_size)           /* Tiles of audio of unknown length: no limit */
+    p->x_size = INT_MAX;
 
-  if (p->y_size) {
+  if (p->y_size)
     p->dft_size = 2 * (p->y_size - 1);
-    if (!is_p2(p->dft_size) && !effp->flow)
-      p->shared = rdft_init(p->dft_size);
-  } else {
+  else {
    int y = max(32, (p->Y_size? p->Y_size : 550) / effp->in_signal.channels - 2);
    for (p->dft_size = 128; p->dft_size <= y; p->dft_size <<= 1);
   }
-  if (is_p2(p->dft_size) && !effp->flow)
-    lsx_safe_rdft(p->dft_size, 1, p->dft_buf);
+  if (!effp->flow)
+    p->shared = lsx_rdft_plan(p->dft_size);
+  p->frames = lsx_malloc(MAX_FRAMES * p->dft_size * sizeof(*p->frames));
+  p->dft_work = lsx_malloc((lsx_rdft_work_len(*p->shared_ptr) + 1) * sizeof(*p->dft_work));
   lsx_debug("duration=%g x_size=%i pixels_per_sec=%g dft_size=%i", duration, p->x_size, pixels_per_sec, p->dft_size);
 
   p->end = p->dft_size;
@@ -246,12 +236,29 @@ static int start(sox_effect_t * effp)
   lsx_debug("step_size=%i block_steps=%i", p->step_size, p->block_steps);
   p->max = -p->dB_range;
   p->read = (p->step_size - p->dft_size) / 2;
+
+  /* When tiling, columns are kept only until their tile has been written;
+   * a flow of input (tiles are written once every channel has had it) adds
+   * at most max_samples / samples-per-column + 1 */
+  p->capacity = !p->tile_cols? p->x_size : p->tile_cols + 2 +
+    max((int)sox_globals.bufsiz, p->dft_size) / (p->step_size * p->block_steps);
+  p->columns = lsx_malloc((size_t)p->capacity * p->rows * sizeof(*p->columns));
   return SOX_SUCCESS;
 }
 
+enum {Background, Text, Labels, Grid, fixed_palette};
+
+static unsigned colour(priv_t const * p, double x)
+{
+  unsigned c = x < -p->dB_range? 0 : x >= 0? p->spectrum_points - 1 :
+      1 + (1 + x / p->dB_range) * (p->spectrum_points - 2);
+  return fixed_palette + c;
+}
+
 static int do_column(sox_effect_t * effp)
 {
   priv_t * p = (priv_t *)effp->priv;
+  png_byte * column;
   int i;
 
   if (p->cols == p->x_size) {
@@ -260,11 +267,10 @@ static int do_column(sox_effect_t * effp)
       lsx_report("PNG truncated at %g seconds", secs(p->cols));
     return p->truncate? SOX_EOF : SOX_SUCCESS;
   }
-  ++p->cols;
-  p->dBfs = lsx_realloc(p->dBfs, p->cols * p->rows * sizeof(*p->dBfs));
+  column = p->columns + (size_t)(p->cols++ % p->capacity) * p->rows;
   for (i = 0; i < p->rows; ++i) {
     double dBfs = 10 * log10(p->magnitudes[i] * p->block_norm);
-    p->dBfs[(p->cols - 1) * p->rows + i] = dBfs + p->gain;
+    column[i] = colour(p, (float)(dBfs + p->gain));
     p->max = max(dBfs, p->max);
   }
   memset(p->magnitudes, 0, p->rows * sizeof(*p->magnitudes));
@@ -272,7 +278,41 @@ static int do_column(sox_effect_t * effp)
   return SOX_SUCCESS;
 }
 
-static int flow(sox_effect_t * effp,
+/* Transforms the windowed frames collected (in parallel, where available),
+ * then adds their power spectra, in order, into the columns */
+static int do_frames(sox_effect_t * effp)
+{
+  priv_t * p = (priv_t *)effp->priv;
+  lsx_rdft_plan_t const * plan = *p->shared_ptr;
+  int i, j, n = p->dft_size, num_frames = p->num_frames;
+
+  p->num_frames = 0;
+#ifdef HAVE_OPENMP
+  #pragma omp parallel if (num_frames > 1) private(j)
+  {
+    double * work = lsx_malloc((lsx_rdft_work_len(plan) + 1) * sizeof(*work));
+    #pragma omp for
+    for (j = 0; j < num_frames; ++j)
+      lsx_rdft_any(plan, p->frames + j * n, work);
+    free(work);
+  }
+#else
+  for (j = 0; j < num_frames; ++j)
+    lsx_rdft_any(plan, p->frames + j * n, p->dft_work);
+#endif
+  for (j = 0; j < num_frames && !p->truncated; ++j) {
+    double const * d = p->frames + j * n;
+    p->magnitudes[0] += sqr(d[0]);
+    for (i = 1; i < n >> 1; ++i)
+      p->magnitudes[i] += sqr(d[2*i]) + sqr(d[2*i+1]);
+    p->magnitudes[n >> 1] += sqr(d[1]);
+    if (++p->block_num == p->block_steps && do_column(effp) == SOX_EOF)
+      return SOX_EOF;
+  }
+  return SOX_SUCCESS;
+}
+
+static int analyse(sox_effect_t * effp,
     const sox_sample_t * ibuf, sox_sample_t * obuf,
     size_t * isamp, size_t * osamp)
 {
@@ -292,6 +332,8 @@ static int flow(sox_effect_t * effp,
     p->skip = 0;
   }
   while (!p->truncated) {
+    double * frame = p->frames + p->num_frames * p->dft_size;
+
     if (p->read == p->step_size) {
       memmove(p->buf, p->buf + p->step_size,
           (p->dft_size - p->step_size) * sizeof(*p->buf));
@@ -305,19 +347,36 @@ static int flow(sox_effect_t * effp,
 
     if ((p->end = max(p->end, p->end_min)) != p->last_end)
       make_window(p, p->last_end = p->end);
-    for (i = 0; i < p->dft_size; ++i) p->dft_buf[i] = p->buf[i] * p->window[i];
-    if (is_p2(p->dft_size)) {
-      lsx_safe_rdft(p->dft_size, 1, p->dft_buf);
-      p->magnitudes[0] += sqr(p->dft_buf[0]);
-      for (i = 1; i < p->dft_size >> 1; ++i)
-        p->magnitudes[i] += sqr(p->dft_buf[2*i]) + sqr(p->dft_buf[2*i+1]);
-      p->magnitudes[p->dft_size >> 1] += sqr(p->dft_buf[1]);
-    }
-    else rdft_p(*p->shared_ptr, p->dft_buf, p->magnitudes, p->dft_size);
-    if (++p->block_num == p->block_steps && do_column(effp) == SOX_EOF)
+    for (i = 0; i < p->dft_size; ++i) frame[i] = p->buf[i] * p->window[i];
+    if (++p->num_frames == MAX_FRAMES && do_frames(effp) == SOX_EOF)
       return SOX_EOF;
   }
-  return SOX_SUCCESS;
+  return p->num_frames? do_frames(effp) : SOX_SUCCESS;
+}
+
+static void write_tiles(sox_effect_t * effp, sox_bool all);
+
+static int flow(sox_effect_t * effp,
+    const sox_sample_t * ibuf, sox_sample_t * obuf,
+    size_t * isamp, size_t * osamp)
+{
+  priv_t * p = (priv_t *)effp->priv;
+  int result = analyse(effp, ibuf, obuf, isamp, osamp);
+  sox_bool last = sox_true;
+
+  /* Channel flows may run concurrently; whichever finishes the input last
+   * writes the tiles, when all channels have made the same columns and none
+   * is adding to its ring */
+  if (p->tile_cols && effp->flows > 1) {
+#ifdef HAVE_OPENMP
+    #pragma omp critical (spectrogram_tiles)
+#endif
+    if ((last = ++*p->flowed_ptr == (int)effp->flows))
+      *p->flowed_ptr = 0;
+  }
+  if (p->tile_cols && last)
+    write_tiles(effp - effp->flow, sox_false);
+  return result;
 }
 
 static int drain(sox_effect_t * effp, sox_sample_t * obuf_, size_t * osamp)
@@ -334,7 +393,7 @@ static int drain(sox_effect_t * effp, sox_sample_t * obuf_, size_t * osamp)
       isamp += p->step_size - left_over;
     lsx_debug("cols=%i left=%i end=%i", p->cols, p->read, p->end);
     p->end = 0, p->end_min = -p->dft_size;
-    if (flow(effp, ibuf, obuf, &isamp, &isamp) == SOX_SUCCESS && p->block_num) {
+    if (analyse(effp, ibuf, obuf, &isamp, &isamp) == SOX_SUCCESS && p->block_num) {
       p->block_norm *= (double)p->block_steps / p->block_num;
       do_column(effp);
     }
@@ -346,15 +405,6 @@ static int drain(sox_effect_t * effp, sox_sample_t * obuf_, size_t * osamp)
   return SOX_SUCCESS;
 }
 
-enum {Background, Text, Labels, Grid, fixed_palette};
-
-static unsigned colour(priv_t const * p, double x)
-{
-  unsigned c = x < -p->dB_range? 0 : x >= 0? p->spectrum_points - 1 :
-      1 + (1 + x / p->dB_range) * (p->spectrum_points - 2);
-  return fixed_palette + c;
-}
-
 static void make_palette(priv_t const * p, png_color * palette)
 {
   int i;
@@ -488,15 +538,16 @@ static int axis(double to, int max_steps, double * limit, char * * prefix)
 #define spectrum_width 14
 #define right 35
 
-static int stop(sox_effect_t * effp)
+/* Writes a PNG of num_cols columns, starting at column col0 */
+static void write_png(sox_effect_t * effp, char const * name, int col0, int num_cols)
 {
   priv_t *    p        = (priv_t *) effp->priv;
-  FILE *      file     = fopen(p->out_name, "wb");
+  FILE *      file     = fopen(name, "wb");
   uLong       font_len = 96 * font_y;
   int         chans    = effp->in_signal.channels;
   int         c_rows   = p->rows * chans + chans - 1;
   int         rows     = p->raw? c_rows : below + c_rows + 30 + 20 * !!p->title;
-  int         cols     = p->raw? p->cols : left + p->cols + between + spectrum_width + right;
+  int         cols     = p->raw? num_cols : left + num_cols + between + spectrum_width + right;
   png_byte *  pixels   = lsx_malloc(cols * rows * sizeof(*pixels));
   png_bytepp  png_rows = lsx_malloc(rows * sizeof(*png_rows));
   png_structp png      = png_create_write_struct(PNG_LIBPNG_VER_STRING, 0, 0,0);
@@ -506,9 +557,8 @@ static int stop(sox_effect_t * effp)
   char        text[200], * prefix;
   double      limit;
 
-  free(p->shared);
   if (!file) {
-    lsx_fail("failed to create `%s': %s", p->out_name, strerror(errno));
+    lsx_fail("failed to create `%s': %s", name, strerror(errno));
     goto error;
   }
   lsx_debug("signal-max=%g", p->max);
@@ -529,12 +579,13 @@ static int stop(sox_effect_t * effp)
     priv_t * q = (priv_t *)(effp - effp->flow + k)->priv;
     base = !p->raw * below + (chans - 1 - k) * (p->rows + 1);
     for (j = 0; j < p->rows; ++j) {
-      for (i = 0; i < p->cols; ++i)
-        pixel(!p->raw * left + i, base + j) = colour(p, q->dBfs[i*p->rows + j]);
+      for (i = 0; i < num_cols; ++i)
+        pixel(!p->raw * left + i, base + j) =
+          q->columns[(size_t)((col0 + i) % p->capacity) * p->rows + j];
       if (!p->raw && !p->no_axes)                                 /* Y-axis lines */
-        pixel(left - 1, base + j) = pixel(left + p->cols, base + j) = Grid;
+        pixel(left - 1, base + j) = pixel(left + num_cols, base + j) = Grid;
     }
-    if (!p->raw && !p->no_axes) for (i = -1; i <= p->cols; ++i)   /* X-axis lines */
+    if (!p->raw && !p->no_axes) for (i = -1; i <= num_cols; ++i)   /* X-axis lines */
       pixel(left + i, base - 1) = pixel(left + i, base + p->rows) = Grid;
   }
 
@@ -546,11 +597,13 @@ static int stop(sox_effect_t * effp)
       print_at(1, font_y, Text, p->comment);
 
     /* X-axis */
-    step = axis(secs(p->cols), p->cols / (font_X * 9 / 2), &limit, &prefix);
-    sprintf(text, "Time (%.1ss)", prefix);               /* Axis label */
-    print_at(left + (p->cols - font_X * (int)strlen(text)) / 2, 24, Text, text);
+    step = axis(secs(num_cols), num_cols / (font_X * 9 / 2), &limit, &prefix);
+    if (p->tile_cols)                                    /* Axis label */
+      sprintf(text, "Time (%.1ss) from %gs", prefix, p->start_time + secs(col0));
+    else sprintf(text, "Time (%.1ss)", prefix);
+    print_at(left + (num_cols - font_X * (int)strlen(text)) / 2, 24, Text, text);
     for (i = 0; i <= limit; i += step) {
-      int y, x = limit? (double)i / limit * p->cols + .5 : 0;
+      int y, x = limit? (double)i / limit * num_cols + .5 : 0;
       for (y = 0; y < tick_len; ++y)                     /* Ticks */
         pixel(left-1+x, below-1-y) = pixel(left-1+x, below+c_rows+y) = Grid;
       if (step == 5 && (i%10))
@@ -571,13 +624,13 @@ static int stop(sox_effect_t * effp)
       for (i = 0; i <= limit; i += step) {
         int x, y = limit? (double)i / limit * (p->rows - 1) + .5 : 0;
         for (x = 0; x < tick_len; ++x)                   /* Ticks */
-          pixel(left-1-x, base+y) = pixel(left+p->cols+x, base+y) = Grid;
+          pixel(left-1-x, base+y) = pixel(left+num_cols+x, base+y) = Grid;
         if ((step == 5 && (i%10)) || (!i && k && chans > 1))
           continue;
         sprintf(text, i?"%5g":"   DC", .1 * i);          /* Tick labels */
         print_at(left - 4 - font_X * 5, base + y + 5, Labels, text);
         sprintf(text, i?"%g":"DC", .1 * i);
-        print_at(left + p->cols + 6, base + y + 5, Labels, text);
+        print_at(left + num_cols + 6, base + y + 5, Labels, text);
       }
     }
 
@@ -604,11 +657,62 @@ static int stop(sox_effect_t * effp)
 error: png_destroy_write_struct(&png, &png_info);
   free(png_rows);
   free(pixels);
-  free(p->dBfs);
+}
+
+/* Writes the tiles completed, or with all set, all the columns left */
+static void write_tiles(sox_effect_t * effp, sox_bool all)
+{
+  priv_t * p = (priv_t *)effp->priv;
+  size_t len = strlen(p->out_name);
+  char * name = lsx_malloc(len + 16);
+
+  if (len > 4 && !strcmp(p->out_name + len - 4, ".png"))
+    len -= 4;
+  if (!p->index) {
+    sprintf(name, "%.*s.txt", (int)len, p->out_name);
+    if (!(p->index = fopen(name, "w")))
+      lsx_fail("failed to create `%s': %s", name, strerror(errno));
+  }
+  while (p->cols - p->cols_written >= (all? 1 : p->tile_cols)) {
+    int n = min(p->tile_cols, p->cols - p->cols_written);
+
+    sprintf(name, "%.*s-%05i.png", (int)len, p->out_name, ++p->tile_num);
+    write_png(effp, name, p->cols_written, n);
+    if (p->index) {
+      fprintf(p->index, "%s %g %g\n", name, p->start_time + secs(p->cols_written),
+          p->start_time + secs(p->cols_written + n));
+      fflush(p->index);
+    }
+    p->cols_written += n;
+  }
+  free(name);
+}
+
+static int stop(sox_effect_t * effp)
+{
+  priv_t * p = (priv_t *)effp->priv;
+
+  if (p->tile_cols) {
+    write_tiles(effp, sox_true);
+    if (p->index)
+      fclose(p->index);
+  }
+  else write_png(effp, p->out_name, 0, p->cols);
+  free(p->shared);
   return SOX_SUCCESS;
 }
 
-static int end(sox_effect_t * effp) {return effp->flow? SOX_SUCCESS:stop(effp);}
+static int end(sox_effect_t * effp)
+{
+  priv_t * p = (priv_t *)effp->priv;
+
+  int result = effp->flow? SOX_SUCCESS : stop(effp);
+
+  free(p->frames);
+  free(p->dft_work);
+  free(p->columns);
+  return result;
+}
 
 sox_effect_handler_t const * lsx_spectrogram_effect_fn(void)
 {
@@ -617,8 +721,9 @@ sox_effect_handler_t const * lsx_spectrogram_effect_fn(void)
   static char const * lines[] = {
     "[options]",
     "\t-x num\tX-axis size in pixels; default derived or 800",
+    "\t-b num\tWrite as tiles num pixels wide, each once complete",
     "\t-X num\tX-axis pixels/second; default derived or 100",
-    "\t-y num\tY-axis size in pixels (per channel); slow if not 1 + 2^n",
+    "\t-y num\tY-axis size in pixels (per channel)",
     "\t-Y num\tY-height total (i.e. not per channel); default 550",
     "\t-z num\tZ-axis range in dB; default 120",
     "\t-Z num\tZ-axis maximum in dBFS; default 0",
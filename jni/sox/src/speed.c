@@ -48,14 +48,27 @@ static int getopts(sox_effect_t * effp, int argc, char * * argv)
   return lsx_usage(effp);
 }
 
+/* The speed is changed by the resampling effect that follows, so here there
+ * is nothing to do but give it the ratio to the starting speed. */
+static int set_param(sox_effect_t * effp, char const * name, double value,
+    double * speed)
+{
+  if (strcmp(name, "factor") || value <= 0)
+    return SOX_EINVAL;
+  if (speed)
+    *speed = value * effp->in_signal.rate / effp->out_signal.rate;
+  return SOX_SUCCESS;
+}
+
 static int start(sox_effect_t * effp)
 {
   priv_t * p = (priv_t *) effp->priv;
 
-  if (p->factor == 1)
+  if (p->factor == 1 && !effp->adjustable)
     return SOX_EFF_NULL;
 
   effp->out_signal.rate = effp->in_signal.rate * p->factor;
+  lsx_effect_set_param(effp, set_param);
   return SOX_SUCCESS;
 }
 
@@ -22,6 +22,16 @@
 #include "sgetopt.h"
 #include <math.h>
 
+#if defined __SSE__ || defined _M_X64 || (defined _M_IX86_FP && _M_IX86_FP >= 1)
+  #define HAVE_SSE_TEMPO
+  #include <xmmintrin.h>
+#elif (defined __ARM_NEON__ || defined __ARM_NEON) && defined SOX_NEON_KERNELS
+  #define HAVE_NEON_TEMPO /* Opt-in (see profile.mk) until checked on ARM */
+  #include <arm_neon.h>
+#endif
+
+#define DFT_COST 4 /* Per sample per log2(DFT length), relative to one SSD term */
+
 typedef struct {
   /* Configuration parameters: */
   size_t channels;
@@ -33,6 +43,10 @@ typedef struct {
 
   size_t process_size;   /* # input wide samples needed to process 1 segment */
 
+  /* For finding the differences of the linear search by DFT: */
+  int dft_length;        /* 0 if differences are found directly */
+  double * dft_buf;      /* 3 * dft_length: 2 for input, 1 for the result */
+
   /* Buffers: */
   fifo_t input_fifo;
   float * overlap_buf;
@@ -43,18 +57,95 @@ typedef struct {
   size_t samples_out;
   size_t segments_total;
   size_t skip_total;
+
+  /* As at the last change of factor: */
+  size_t segments_base, skip_base;
+  double in_done, out_done;  /* Input consumed, & output due for it */
 } tempo_t;
 
 /* Waveform Similarity by least squares; works across multi-channels */
 static float difference(const float * a, const float * b, size_t length)
 {
-  float diff = 0;
   size_t i = 0;
+#if defined HAVE_SSE_TEMPO
+  __m128 d0 = _mm_setzero_ps(), d1 = d0, x;
+
+  do { /* N.B. length ≡ 0 (mod 8) */
+    x = _mm_sub_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i));
+    d0 = _mm_add_ps(d0, _mm_mul_ps(x, x));
+    x = _mm_sub_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4));
+    d1 = _mm_add_ps(d1, _mm_mul_ps(x, x));
+  } while ((i += 8) < length);
+  d0 = _mm_add_ps(d0, d1);
+  d0 = _mm_add_ps(d0, _mm_movehl_ps(d0, d0));
+  return _mm_cvtss_f32(_mm_add_ss(d0, _mm_shuffle_ps(d0, d0, 1)));
+#elif defined HAVE_NEON_TEMPO
+  float32x4_t d0 = vdupq_n_f32(0), d1 = d0, x;
+  float32x2_t d;
+
+  do { /* N.B. length ≡ 0 (mod 8) */
+    x = vsubq_f32(vld1q_f32(a + i), vld1q_f32(b + i));
+    d0 = vmlaq_f32(d0, x, x);
+    x = vsubq_f32(vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+    d1 = vmlaq_f32(d1, x, x);
+  } while ((i += 8) < length);
+  d0 = vaddq_f32(d0, d1);
+  d = vadd_f32(vget_low_f32(d0), vget_high_f32(d0));
+  return vget_lane_f32(vpadd_f32(d, d), 0);
+#else
+  float diff = 0;
 
   #define _ diff += sqr(a[i] - b[i]), ++i; /* Loop optimisation */
   do {_ _ _ _ _ _ _ _} while (i < length); /* N.B. length ≡ 0 (mod 8) */
   #undef _
   return diff;
+#endif
+}
+
+/* The linear search, with the differences found all at once: for position
+ * i, sum(sqr(a - b)) = sum(sqr(a)) - 2 * sum(a * b) + sum(sqr(b)), where
+ * the last term is the same for every i and so is left out, the first is a
+ * running sum, and the middle one is the cross-correlation of the channels
+ * of a & b, found by DFT.  The differences so found are rounded otherwise
+ * than by difference(), so where two positions are all but equally good,
+ * the other one may be chosen. */
+static size_t tempo_best_overlap_position_dft(tempo_t * t, float const * new_win)
+{
+  size_t c, i, best_pos = 0, chans = t->channels, len = t->search + t->overlap - 1;
+  int n = t->dft_length;
+  double * a = t->dft_buf, * b = a + n, * x = b + n;
+  double energy = 0, diff, least_diff = HUGE_VAL;
+
+  for (c = 0; c < chans; ++c) {
+    for (i = 0; i < len; ++i)
+      a[i] = new_win[i * chans + c];
+    memset(a + len, 0, (n - len) * sizeof(*a));
+    for (i = 0; i < t->overlap; ++i)
+      b[i] = t->overlap_buf[i * chans + c];
+    memset(b + t->overlap, 0, (n - t->overlap) * sizeof(*b));
+    lsx_safe_rdft(n, 1, a);
+    lsx_safe_rdft(n, 1, b);
+    if (!c)
+      memset(x, 0, n * sizeof(*x));
+    x[0] += a[0] * b[0];                         /* a times conjugate b */
+    x[1] += a[1] * b[1];
+    for (i = 2; i < (size_t)n; i += 2) {
+      x[i] += a[i] * b[i] + a[i + 1] * b[i + 1];
+      x[i + 1] += a[i + 1] * b[i] - a[i] * b[i + 1];
+    }
+  }
+  lsx_safe_rdft(n, -1, x);                       /* Scaled by n / 2 */
+
+  for (i = 0; i < t->overlap * chans; ++i)
+    energy += sqr(new_win[i]);
+  for (i = 0; i < t->search; ++i) {
+    diff = energy - x[i] * (4. / n);
+    if (diff < least_diff)
+      least_diff = diff, best_pos = i;
+    for (c = 0; c < chans; ++c)
+      energy += sqr(new_win[(i + t->overlap) * chans + c]) - sqr(new_win[i * chans + c]);
+  }
+  return best_pos;
 }
 
 /* Find where the two segments are most alike over the overlap period. */
@@ -63,9 +154,12 @@ static size_t tempo_best_overlap_position(tempo_t * t, float const * new_win)
   float * f = t->overlap_buf;
   size_t j, best_pos, prev_best_pos = (t->search + 1) >> 1, step = 64;
   size_t i = best_pos = t->quick_search? prev_best_pos : 0;
-  float diff, least_diff = difference(new_win + t->channels * i, f, t->channels * t->overlap);
+  float diff, least_diff;
   int k = 0;
 
+  if (!t->quick_search && t->dft_length)
+    return tempo_best_overlap_position_dft(t, new_win);
+  least_diff = difference(new_win + t->channels * i, f, t->channels * t->overlap);
   if (t->quick_search) do { /* hierarchical search */
     for (k = -1; k <= 1; k += 2) for (j = 1; j < 4 || step == 64; ++j) {
       i = prev_best_pos + k * j * step;
@@ -127,8 +221,9 @@ static void tempo_process(tempo_t * t)
            t->channels * t->overlap * sizeof(*(t->overlap_buf)));
 
     /* Advance through the input stream */
-    skip = t->factor * (++t->segments_total * (t->segment - t->overlap)) + 0.5;
-    t->skip_total += skip -= t->skip_total;
+    skip = t->factor * ((++t->segments_total - t->segments_base) *
+        (t->segment - t->overlap)) + 0.5;
+    t->skip_total += skip -= t->skip_total - t->skip_base;
     fifo_read(&t->input_fifo, skip, NULL);
   }
 }
@@ -148,7 +243,7 @@ static float const * tempo_output(tempo_t * t, float * samples, size_t * n)
 /* Flush samples remaining in overlap_buf & input_fifo to the output. */
 static void tempo_flush(tempo_t * t)
 {
-  size_t samples_out = t->samples_in / t->factor + .5;
+  size_t samples_out = t->out_done + (t->samples_in - t->in_done) / t->factor + .5;
   size_t remaining = samples_out - t->samples_out;
   float * buff = lsx_calloc(128 * t->channels, sizeof(*buff));
 
@@ -164,7 +259,8 @@ static void tempo_flush(tempo_t * t)
 }
 
 static void tempo_setup(tempo_t * t,
-  double sample_rate, sox_bool quick_search, double factor,
+  double sample_rate, sox_bool quick_search, sox_bool direct_search,
+  double factor,
   double segment_ms, double search_ms, double overlap_ms)
 {
   size_t max_skip;
@@ -179,12 +275,41 @@ static void tempo_setup(tempo_t * t,
   t->overlap_buf = lsx_malloc(t->overlap * t->channels * sizeof(*t->overlap_buf));
   max_skip = ceil(factor * (t->segment - t->overlap));
   t->process_size = max(max_skip + t->overlap, t->segment) + t->search;
+
+  /* Unless told not to, use a DFT for the linear search when it looks to be
+   * cheaper */
+  if (!quick_search && !direct_search && t->search > 1) {
+    double direct, by_dft;
+    for (t->dft_length = 2; t->dft_length < (int)(t->search + t->overlap - 1);
+        t->dft_length <<= 1);
+    direct = (double)t->search * t->overlap * t->channels;
+    by_dft = DFT_COST * (2. * t->channels + 1) * t->dft_length *
+      log((double)t->dft_length) / log(2.);
+    if (direct > by_dft)
+      t->dft_buf = lsx_malloc(3 * t->dft_length * sizeof(*t->dft_buf));
+    else t->dft_length = 0;
+  }
   memset(fifo_reserve(&t->input_fifo, t->search / 2), 0, (t->search / 2) * t->channels * sizeof(float));
 }
 
+/* Changes factor from the next segment on */
+static void tempo_set_factor(tempo_t * t, double factor)
+{
+  size_t max_skip = ceil(factor * (t->segment - t->overlap));
+  double in_done = (double)t->skip_total - t->search / 2;
+
+  t->out_done += (in_done - t->in_done) / t->factor;
+  t->in_done = in_done;
+  t->factor = factor;
+  t->segments_base = t->segments_total;
+  t->skip_base = t->skip_total;
+  t->process_size = max(max_skip + t->overlap, t->segment) + t->search;
+}
+
 static void tempo_delete(tempo_t * t)
 {
   free(t->overlap_buf);
+  free(t->dft_buf);
   fifo_delete(&t->output_fifo);
   fifo_delete(&t->input_fifo);
   free(t);
@@ -203,8 +328,9 @@ static tempo_t * tempo_create(size_t channels)
 
 typedef struct {
   tempo_t     * tempo;
-  sox_bool    quick_search;
+  sox_bool    quick_search, direct_search;
   double      factor, segment_ms, search_ms, overlap_ms;
+  lsx_param_t new_factor;  /* Set while running */
 } priv_t;
 
 static int getopts(sox_effect_t * effp, int argc, char **argv)
@@ -218,8 +344,9 @@ static int getopts(sox_effect_t * effp, int argc, char **argv)
   int c;
 
   p->segment_ms = p->search_ms = p->overlap_ms = HUGE_VAL;
-  while ((c = lsx_getopt(argc, argv, "+qmls")) != -1) switch (c) {
+  while ((c = lsx_getopt(argc, argv, "+qtmls")) != -1) switch (c) {
     case 'q': p->quick_search  = sox_true;   break;
+    case 't': p->direct_search = sox_true;   break;
     case 'm': profile = Music; break;
     case 's': profile = Speech; break;
     case 'l': profile = Linear; p->search_ms = 0; break;
@@ -241,20 +368,77 @@ static int getopts(sox_effect_t * effp, int argc, char **argv)
     p->search_ms = p->segment_ms / searches_div[profile];
 
   p->overlap_ms = min(p->overlap_ms, p->segment_ms / 2);
-  lsx_report("quick_search=%u factor=%g segment=%g search=%g overlap=%g",
-    p->quick_search, p->factor, p->segment_ms, p->search_ms, p->overlap_ms);
+  lsx_report("quick_search=%u direct_search=%u factor=%g segment=%g search=%g overlap=%g",
+    p->quick_search, p->direct_search, p->factor, p->segment_ms, p->search_ms, p->overlap_ms);
   return argc? lsx_usage(effp) : SOX_SUCCESS;
 }
 
+static int set_param(sox_effect_t * effp, char const * name, double value,
+    double * speed)
+{
+  priv_t * p = (priv_t *)effp->priv;
+
+  if (strcmp(name, "factor") || value < .1 || value > 100)
+    return SOX_EINVAL;
+  if (!speed)
+    lsx_param_set(&p->new_factor, value);
+  return SOX_SUCCESS;
+}
+
+/* Takes up a factor set while running; segment, search & overlap stay as
+ * they were set up for the starting factor. */
+static void adjust(sox_effect_t * effp)
+{
+  priv_t * p = (priv_t *)effp->priv;
+  double factor;
+
+  if (lsx_param_get(effp, &p->new_factor, &factor))
+    tempo_set_factor(p->tempo, factor);
+}
+
+/* The float versions need no conversion: tempo works in float throughout */
+static int flow_f(sox_effect_t * effp, const float * ibuf,
+                float * obuf, size_t * isamp, size_t * osamp)
+{
+  priv_t * p = (priv_t *)effp->priv;
+  size_t odone = *osamp /= effp->in_signal.channels;
+  float const * s;
+
+  adjust(effp);
+  s = tempo_output(p->tempo, NULL, &odone);
+  memcpy(obuf, s, odone * effp->in_signal.channels * sizeof(*obuf));
+
+  if (*isamp && odone < *osamp) {
+    float * t = tempo_input(p->tempo, NULL, *isamp / effp->in_signal.channels);
+    memcpy(t, ibuf, *isamp * sizeof(*t));
+    tempo_process(p->tempo);
+  }
+  else *isamp = 0;
+
+  *osamp = odone * effp->in_signal.channels;
+  return SOX_SUCCESS;
+}
+
+static int drain_f(sox_effect_t * effp, float * obuf, size_t * osamp)
+{
+  priv_t * p = (priv_t *)effp->priv;
+  size_t isamp = 0;
+  tempo_flush(p->tempo);
+  return flow_f(effp, 0, obuf, &isamp, osamp);
+}
+
 static int start(sox_effect_t * effp)
 {
   priv_t * p = (priv_t *)effp->priv;
-  if (p->factor == 1)
+  if (p->factor == 1 && !effp->adjustable)
     return SOX_EFF_NULL;
 
   p->tempo = tempo_create((size_t)effp->in_signal.channels);
-  tempo_setup(p->tempo, effp->in_signal.rate, p->quick_search, p->factor,
+  tempo_setup(p->tempo, effp->in_signal.rate, p->quick_search,
+      p->direct_search, p->factor,
       p->segment_ms, p->search_ms, p->overlap_ms);
+  lsx_effect_set_float(effp, flow_f, drain_f);
+  lsx_effect_set_param(effp, set_param);
   return SOX_SUCCESS;
 }
 
@@ -263,9 +447,11 @@ static int flow(sox_effect_t * effp, const sox_sample_t * ibuf,
 {
   priv_t * p = (priv_t *)effp->priv;
   size_t i, odone = *osamp /= effp->in_signal.channels;
-  float const * s = tempo_output(p->tempo, NULL, &odone);
+  float const * s;
   SOX_SAMPLE_LOCALS;
 
+  adjust(effp);
+  s = tempo_output(p->tempo, NULL, &odone);
   for (i = 0; i < odone * effp->in_signal.channels; ++i)
     *obuf++ = SOX_FLOAT_32BIT_TO_SAMPLE(*s++, effp->clips);
 
@@ -299,7 +485,7 @@ static int stop(sox_effect_t * effp)
 sox_effect_handler_t const * lsx_tempo_effect_fn(void)
 {
   static sox_effect_handler_t handler = {
-    "tempo", "[-q] [-m | -s | -l] factor [segment-ms [search-ms [overlap-ms]]]",
+    "tempo", "[-q | -t] [-m | -s | -l] factor [segment-ms [search-ms [overlap-ms]]]",
     SOX_EFF_MCHAN | SOX_EFF_LENGTH,
     getopts, start, flow, drain, stop, NULL, sizeof(priv_t)
   };
@@ -312,7 +498,10 @@ static int pitch_getopts(sox_effect_t * effp, int argc, char **argv)
 {
   double d;
   char dummy, arg[100], **argv2 = lsx_malloc(argc * sizeof(*argv2));
-  int result, pos = (argc > 1 && !strcmp(argv[1], "-q"))? 2 : 1;
+  int result, pos = 1;
+
+  while (pos < argc && (!strcmp(argv[pos], "-q") || !strcmp(argv[pos], "-t")))
+    ++pos;
 
   if (argc <= pos || sscanf(argv[pos], "%lf %c", &d, &dummy) != 1)
     return lsx_usage(effp);
@@ -326,12 +515,28 @@ static int pitch_getopts(sox_effect_t * effp, int argc, char **argv)
   return result;
 }
 
+/* As the pitch changes, so must the rate at which the output is played: the
+ * resampling effect that follows is given the ratio to the starting rate. */
+static int pitch_set_param(sox_effect_t * effp, char const * name,
+    double value, double * speed)
+{
+  double d = pow(2., value / 1200);  /* cents --> factor */
+
+  if (strcmp(name, "cents") || set_param(effp, "factor", 1 / d, speed) != SOX_SUCCESS)
+    return SOX_EINVAL;
+  if (speed)
+    *speed = d * effp->in_signal.rate / effp->out_signal.rate;
+  else set_param(effp, "factor", 1 / d, NULL);
+  return SOX_SUCCESS;
+}
+
 static int pitch_start(sox_effect_t * effp)
 {
   priv_t * p = (priv_t *) effp->priv;
   int result = start(effp);
 
   effp->out_signal.rate = effp->in_signal.rate / p->factor;
+  lsx_effect_set_param(effp, pitch_set_param);
   return result;
 }
 
@@ -340,7 +545,7 @@ sox_effect_handler_t const * lsx_pitch_effect_fn(void)
   static sox_effect_handler_t handler;
   handler = *lsx_tempo_effect_fn();
   handler.name = "pitch";
-  handler.usage = "[-q] shift-in-cents [segment-ms [search-ms [overlap-ms]]]",
+  handler.usage = "[-q | -t] shift-in-cents [segment-ms [search-ms [overlap-ms]]]",
   handler.getopts = pitch_getopts;
   handler.start = pitch_start;
   handler.flags &= ~SOX_EFF_LENGTH;
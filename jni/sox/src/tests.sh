@@ -259,6 +259,17 @@ else
 fi
 rm output.u8
 
+${bindir}/sox${EXEEXT} -c 2 -r 44100 -n input.wav synth 1 sine 300 sine 3000 vol .5
+${bindir}/sox${EXEEXT} input.wav output.wav vol 1.5 tempo 1.2 rate 22050
+${bindir}/sox${EXEEXT} --float input.wav output2.wav vol 1.5 tempo 1.2 rate 22050
+if ${bindir}/sox${EXEEXT} -m -v 1 output.wav -v -1 output2.wav -n stat 2>&1 |
+    grep -q "^Maximum amplitude: *0\.0000"; then
+  echo "ok     float effects"
+else
+  echo "*FAIL* float effects"
+fi
+rm input.wav output.wav output2.wav
+
 echo "Checked $vectors vectors"
 
 channels=2
@@ -303,3 +303,14 @@ void lsx_close_dllibrary(
   }
 #endif /* HAVE_LIBLTDL */
 }
+
+#ifdef LSX_AVX2
+sox_bool lsx_have_avx2(void)
+{
+  static int avx2 = -1; /* A racing first call merely repeats the test */
+
+  if (avx2 < 0)
+    avx2 = __builtin_cpu_supports("avx2") != 0;
+  return avx2;
+}
+#endif
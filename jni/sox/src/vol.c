@@ -22,8 +22,13 @@ typedef struct {
   double    limitergain;
   int       limited; /* number of limited values to report. */
   int       totalprocessed;
+  lsx_param_t new_gain; /* Set while running */
+  double    target, ramp_step;
+  size_t    ramp;     /* Wide samples left until gain reaches target */
 } priv_t;
 
+#define RAMP_MS 10    /* Time over which gain moves to a new value */
+
 enum {vol_amplitude, vol_dB, vol_power};
 
 static lsx_enum_item const vol_types[] = {
@@ -88,6 +93,77 @@ static int getopts(sox_effect_t * effp, int argc, char **argv)
   return SOX_SUCCESS;
 }
 
+static int set_param(sox_effect_t * effp, char const * name, double value,
+    double * speed)
+{
+  priv_t * vol = (priv_t *) effp->priv;
+
+  if (strcmp(name, "gain") || (vol->uselimiter && fabs(value) <= 1))
+    return SOX_EINVAL;
+  if (!speed)
+    lsx_param_set(&vol->new_gain, value);
+  return SOX_SUCCESS;
+}
+
+/* Takes up a gain set while running; it is ramped to over RAMP_MS, and the
+ * limiter (which is not applied during the ramp) adapts to it at once. */
+static void adjust(sox_effect_t * effp)
+{
+  priv_t * vol = (priv_t *) effp->priv;
+  double gain;
+
+  if (lsx_param_get(effp, &vol->new_gain, &gain)) {
+    vol->ramp = max(1, effp->in_signal.rate * RAMP_MS / 1000);
+    vol->ramp_step = (gain - vol->gain) / vol->ramp;
+    vol->target = gain;
+    if (vol->uselimiter)
+      vol->limiterthreshhold = SOX_SAMPLE_MAX * (1.0 - vol->limitergain) / (fabs(gain) - vol->limitergain);
+  }
+}
+
+/* As flow, but in float: full scale is 1 and there is headroom, so there is
+ * no clipping here. */
+static int flow_f(sox_effect_t * effp, const float *ibuf, float *obuf,
+                  size_t *isamp, size_t *osamp)
+{
+    priv_t * vol = (priv_t *) effp->priv;
+    float gain, limiterthreshhold;
+    float limitergain = vol->limitergain;
+    float sample;
+    size_t c, len = min(*osamp, *isamp);
+
+    *isamp = len; *osamp = len;
+
+    adjust(effp);
+    for (; vol->ramp && len >= effp->in_signal.channels; len -= c) {
+        vol->gain = --vol->ramp? vol->gain + vol->ramp_step : vol->target;
+        for (c = 0; c < effp->in_signal.channels; ++c)
+            *obuf++ = vol->gain * *ibuf++;
+    }
+    gain = vol->gain;
+    limiterthreshhold = vol->limiterthreshhold / SOX_SAMPLE_MAX;
+
+    if (vol->uselimiter) {
+        vol->totalprocessed += len;
+        for (; len > 0; len--) {
+            sample = *ibuf++;
+            if (sample > limiterthreshhold) {
+                sample = 1 - limitergain * (1 - sample);
+                vol->limited++;
+            }
+            else if (sample < -limiterthreshhold) {
+                sample = -(1 - limitergain * (1 + sample));
+                vol->limited++;
+            }
+            else sample *= gain;
+            *obuf++ = sample;
+        }
+    }
+    else for (; len > 0; len--)
+        *obuf++ = gain * *ibuf++;
+    return SOX_SUCCESS;
+}
+
 /*
  * Start processing
  */
@@ -95,12 +171,14 @@ static int start(sox_effect_t * effp)
 {
     priv_t * vol = (priv_t *) effp->priv;
 
-    if (vol->gain == 1)
+    if (vol->gain == 1 && !effp->adjustable)
       return SOX_EFF_NULL;
 
     vol->limited = 0;
     vol->totalprocessed = 0;
 
+    lsx_effect_set_float(effp, flow_f, NULL);
+    lsx_effect_set_param(effp, set_param);
     return SOX_SUCCESS;
 }
 
@@ -111,16 +189,29 @@ static int flow(sox_effect_t * effp, const sox_sample_t *ibuf, sox_sample_t *obu
                 size_t *isamp, size_t *osamp)
 {
     priv_t * vol = (priv_t *) effp->priv;
-    register double gain = vol->gain;
-    register double limiterthreshhold = vol->limiterthreshhold;
+    register double gain;
+    register double limiterthreshhold;
     register double sample;
     register size_t len;
+    size_t c;
 
     len = min(*osamp, *isamp);
 
     /* report back dealt with amount. */
     *isamp = len; *osamp = len;
 
+    adjust(effp);
+    for (; vol->ramp && len >= effp->in_signal.channels; len -= c) {
+        vol->gain = --vol->ramp? vol->gain + vol->ramp_step : vol->target;
+        for (c = 0; c < effp->in_signal.channels; ++c) {
+            sample = vol->gain * *ibuf++;
+            SOX_SAMPLE_CLIP_COUNT(sample, effp->clips);
+            *obuf++ = sample;
+        }
+    }
+    gain = vol->gain;
+    limiterthreshhold = vol->limiterthreshhold;
+
     if (vol->uselimiter)
     {
         vol->totalprocessed += len;
@@ -27,12 +27,6 @@
 #include <vorbis/vorbisfile.h>
 #include <vorbis/vorbisenc.h>
 
-#define DEF_BUF_LEN 4096
-
-#define BUF_ERROR -1
-#define BUF_EOF  0
-#define BUF_DATA 1
-
 #define HEADER_ERROR 0
 #define HEADER_OK   1
 
@@ -50,10 +44,6 @@ typedef struct {
 typedef struct {
   /* Decoding data */
   OggVorbis_File *vf;
-  char *buf;
-  size_t buf_len;
-  size_t start;
-  size_t end;     /* Unsent data samples in buf[start] through buf[end-1] */
   int current_section;
   int eof;
 
@@ -129,11 +119,6 @@ static int startread(sox_format_t * ft)
   for (i = 0; i < vc->comments; i++)
     sox_append_comment(&ft->oob.comments, vc->user_comments[i]);
 
-  /* Setup buffer */
-  vb->buf_len = DEF_BUF_LEN;
-  vb->buf = lsx_calloc(vb->buf_len, sizeof(char));
-  vb->start = vb->end = 0;
-
   /* Fill in other info */
   vb->eof = 0;
   vb->current_section = -1;
@@ -142,35 +127,10 @@ static int startread(sox_format_t * ft)
 }
 
 
-/* Refill the buffer with samples.  Returns BUF_EOF if the end of the
- * vorbis data was reached while the buffer was being filled,
- * BUF_ERROR is something bad happens, and BUF_DATA otherwise */
-static int refill_buffer(priv_t * vb)
-{
-  int num_read;
-
-  if (vb->start == vb->end)     /* Samples all played */
-    vb->start = vb->end = 0;
-
-  while (vb->end < vb->buf_len) {
-    num_read = ov_read(vb->vf, vb->buf + vb->end,
-        (int) (vb->buf_len - vb->end), 0, 2, 1, &vb->current_section);
-    if (num_read == 0)
-      return (BUF_EOF);
-    else if (num_read == OV_HOLE)
-      lsx_warn("Warning: hole in stream; probably harmless");
-    else if (num_read < 0)
-      return (BUF_ERROR);
-    else
-      vb->end += num_read;
-  }
-  return (BUF_DATA);
-}
-
-
 /*
  * Read up to len samples from file.
- * Convert to signed longs.
+ * libvorbisfile's float output is taken directly & converted
+ * (without loss of precision) to interleaved sox_sample_t.
  * Place in buf[].
  * Return number of samples read.
  */
@@ -178,29 +138,25 @@ static int refill_buffer(priv_t * vb)
 static size_t read_samples(sox_format_t * ft, sox_sample_t * buf, size_t len)
 {
   priv_t * vb = (priv_t *) ft->priv;
-  size_t i;
-  int ret;
-  sox_sample_t l;
-
-
-  for (i = 0; i < len; i++) {
-    if (vb->start == vb->end) {
-      if (vb->eof)
-        break;
-      ret = refill_buffer(vb);
-      if (ret == BUF_EOF || ret == BUF_ERROR) {
-        vb->eof = 1;
-        if (vb->end == 0)
-          break;
-      }
+  unsigned channels = ft->signal.channels;
+  size_t done = 0;
+  float ** pcm;
+  long n;
+
+  while (!vb->eof && (len - done) / channels) {
+    n = ov_read_float(vb->vf, &pcm, (int)min((len - done) / channels, (size_t)INT_MAX),
+        &vb->current_section);
+    if (n == OV_HOLE)
+      lsx_warn("Warning: hole in stream; probably harmless");
+    else if (n <= 0)
+      vb->eof = 1;
+    else {
+      ft->clips += lsx_f32_planar_to_samples(
+          buf + done, (float const * const *)pcm, (size_t)n, channels);
+      done += (size_t)n * channels;
     }
-
-    l = (vb->buf[vb->start + 1] << 24)
-        | (0xffffff & (vb->buf[vb->start] << 16));
-    *(buf + i) = l;
-    vb->start += 2;
   }
-  return i;
+  return done;
 }
 
 /*
@@ -211,7 +167,6 @@ static int stopread(sox_format_t * ft)
 {
   priv_t * vb = (priv_t *) ft->priv;
 
-  free(vb->buf);
   ov_clear(vb->vf);
 
   return (SOX_SUCCESS);
@@ -393,7 +348,10 @@ static int seek(sox_format_t * ft, uint64_t offset)
 {
   priv_t * vb = (priv_t *) ft->priv;
 
-  return ov_pcm_seek(vb->vf, (ogg_int64_t)(offset / ft->signal.channels))? SOX_EOF:SOX_SUCCESS;
+  if (ov_pcm_seek(vb->vf, (ogg_int64_t)(offset / ft->signal.channels)))
+    return SOX_EOF;
+  vb->eof = 0;
+  return SOX_SUCCESS;
 }
 
 LSX_FORMAT_HANDLER(vorbis)
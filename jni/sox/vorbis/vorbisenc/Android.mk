@@ -10,6 +10,8 @@ include $(CLEAR_VARS)
 
 
 LOCAL_MODULE := libvorbisenc
+LOCAL_ARM_MODE := arm
+LOCAL_ARM_NEON := $(SOX_ARM_NEON)
 
 LOCAL_C_INCLUDES := $(LOCAL_PATH) \
 $(LOCAL_PATH)/../include \
@@ -21,6 +23,7 @@ LOCAL_SRC_FILES := vorbisenc.c
 LOCAL_SHARED_LIBRARIES := liblpc10 libgsm libogg libvorbis	
 
 
+LOCAL_CFLAGS := $(SOX_CFLAGS)
 LOCAL_LDLIBS := -ldl -lGLESv1_CM -llog -L$(DIRECTORY_TO_OBJ)
 
 include $(BUILD_SHARED_LIBRARY)
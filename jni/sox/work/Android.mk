@@ -5,6 +5,7 @@ include $(CLEAR_VARS)
 
 LOCAL_MODULE := libplayer
 LOCAL_ARM_MODE := arm
+LOCAL_ARM_NEON := $(SOX_ARM_NEON)
 LOCAL_C_INCLUDES := $(LOCAL_PATH) \
 $(LOCAL_PATH)/../libogg/include/ \
 $(LOCAL_PATH)/../vorbis/include/ \
@@ -20,7 +21,7 @@ $(LOCAL_PATH)/../src/ \
 
 LOCAL_SRC_FILES := test.c
 
-LOCAL_CFLAGS           := -Wall -g
+LOCAL_CFLAGS           := -Wall $(SOX_CFLAGS)
 LOCAL_LDFLAGS          := -Wl,-Map,xxx.map
 
 LOCAL_SHARED_LIBRARIES := liblpc10 libgsm libogg libfmemopen libvorbis libvorbisenc libvorbisfile libFLAC libmp3lame libmad libpng libsndfile libwavpack libsox
@@ -41,77 +41,71 @@
 sox_format_t * in, *in2;
 sox_format_t * out;
 sox_effects_chain_t * chain;
-struct thread_data {
-	size_t *buffer_size;
-	char *buffer[18432];
-
-};
-size_t buffer_size;
-struct thread_data thread_data;
-int alldone;
-JNIEnv* env2;
-jobject obj2;
+sox_effects_chain_t * playing;   /* chain while it runs; see set_param */
+pthread_mutex_t playing_lock = PTHREAD_MUTEX_INITIALIZER;
+JavaVM* vm;
 jclass cls;
-jmethodID mid, mid2;
-jbyteArray array2;
-char *buffer;
+jmethodID mid;
 
-void *thread_func() {
-
-	int numbers = 0;
-
-	while (alldone != 2) {
-
-		int buf = buffer_size;
-		if (buffer_size != numbers) {
+#define RING_SIZE (size_t)65536  /* Bytes of PCM queued between chain and player */
 
-			int send = 0;
-			while (send < buf - numbers) {
+sox_ring_t * ring;
 
-				if (buf - numbers - send < 17000) {
-
-					jbyte *bytes = (*env2)->GetByteArrayElements(env2, array2,
-							NULL);
-					memmove(bytes, (jbyte *) (buffer + numbers + send),
-							(buf - numbers - send));
-					(*env2)->ReleaseByteArrayElements(env2, array2,
-							(jbyte *) bytes, 0);
+/* Drains the ring into AudioTrack.  Java sees the ring's own storage as one
+ * direct ByteBuffer, so PCM goes from the chain to AudioTrack without being
+ * copied on the way, and only an offset and length cross into Java.  Each
+ * call hands over all the PCM that lies in one piece, while the chain goes on
+ * filling the rest of the ring.  Sleeps in sox_ring_peek while the chain is
+ * still producing, and returns once the output has been closed, or once
+ * AudioTrack fails, in which case the ring is aborted so that the chain stops
+ * too. */
+void *thread_func() {
 
-					(*env2)->CallStaticVoidMethod(env2, cls, mid,
-							buf - numbers - send);
+	JNIEnv* env;
+	size_t len, offset;
+	jint written;
 
-					send += buf - numbers - send;
-				} else {
+	if ((*vm)->AttachCurrentThread(vm, &env, NULL) != JNI_OK) {
+		sox_ring_abort(ring);
+		return NULL;
+	}
+	while ((len = sox_ring_peek(ring, &offset)) != 0) {
+		written = (*env)->CallStaticIntMethod(env, cls, mid, (jint) offset,
+				(jint) len);
+		if ((*env)->ExceptionCheck(env) || written <= 0) {
+			(*env)->ExceptionClear(env);
+			sox_ring_abort(ring);
+			break;
+		}
+		sox_ring_consume(ring, (size_t) written);
+	}
+	(*vm)->DetachCurrentThread(vm);
+	return NULL;
 
-					jbyte *bytes = (*env2)->GetByteArrayElements(env2, array2,
-							NULL);
+}
 
-					memmove(bytes, (jbyte *) (buffer + numbers + send), 17000);
-					(*env2)->ReleaseByteArrayElements(env2, array2,
-							(jbyte *) bytes, 0);
-					(*env2)->CallStaticVoidMethod(env2, cls, mid, 17000);
-					send += 17000;
-				}
-			}
-			if (alldone == 1) {
-				alldone = 2;
-			}
-		}
+/* Wraps the ring's storage as a direct ByteBuffer and hands it to Java */
+static int share_ring(JNIEnv* env) {
 
-		numbers = buf;
+	jmethodID set = (*env)->GetStaticMethodID(env, cls, "setBuffer",
+			"(Ljava/nio/ByteBuffer;)V");
+	size_t size;
+	void * data = sox_ring_buffer(ring, &size);
+	jobject b;
 
-	}
+	if (!set || !(b = (*env)->NewDirectByteBuffer(env, data, (jlong) size)))
+		return -1;
+	(*env)->CallStaticVoidMethod(env, cls, set, b);
+	(*env)->DeleteLocalRef(env, b);
+	return 0;
 
 }
 
 JNIEXPORT jint JNICALL Java_com_sox_player_SoxPlayerActivity_play(JNIEnv* env,
-		jobject obj, jbyteArray array) {
+		jobject obj) {
 	int argc;
 	char * args[3];
 	char * argv[3];
-	obj2 = obj;
-	env2 = env;
-	array2 = array;
 
 	sox_effects_chain_t * chain;
 	sox_effect_t * e;
@@ -127,24 +121,50 @@ JNIEXPORT jint JNICALL Java_com_sox_player_SoxPlayerActivity_play(JNIEnv* env,
 	in = sox_open_read(argv[1], NULL, NULL, NULL);
 #define MAX_SAMPLES (size_t)2000000
 
-	cls = (*env)->GetObjectClass(env, obj);
-	mid = (*env)->GetStaticMethodID(env, cls, "writeBytes", "(I)V");
-
-	out = sox_open_memstream_write(&buffer, &buffer_size, &in->signal, NULL,
-			"sox", NULL);
-	in->encoding.bits_per_sample = 16;
-	out->encoding.bits_per_sample = 16;
-
+	/* The class and VM (unlike env) remain valid on the player thread */
+	(*env)->GetJavaVM(env, &vm);
+	jclass local_cls = (*env)->GetObjectClass(env, obj);
+	cls = (*env)->NewGlobalRef(env, local_cls);
+	(*env)->DeleteLocalRef(env, local_cls);
+	mid = (*env)->GetStaticMethodID(env, cls, "writeBlock", "(II)I");
+
+	/* Stream 16-bit native-endian PCM through a fixed-size ring, so memory
+	 * use does not depend on the length of the track */
+	sox_encodinginfo_t out_encoding = { SOX_ENCODING_SIGN2, 16, 0,
+			SOX_OPTION_DEFAULT, SOX_OPTION_DEFAULT, SOX_OPTION_DEFAULT,
+			sox_false };
 	pthread_t thread;
 	pthread_attr_t attr;
-	int rc;
+	int rc = -1;
 	void *status;
 
-	pthread_attr_init(&attr);
-	pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
-	rc = pthread_create(&thread, &attr, thread_func, NULL);
+	ring = sox_ring_create(RING_SIZE);
+	out = NULL;
+	if (in && mid && ring && share_ring(env) == 0)
+		out = sox_open_ring_write(ring, &in->signal, &out_encoding, NULL);
+	if (out) {
+		pthread_attr_init(&attr);
+		pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
+		rc = pthread_create(&thread, &attr, thread_func, NULL);
+		pthread_attr_destroy(&attr);
+	}
+	if (rc != 0) {
+		if (out)
+			sox_close(out);
+		sox_ring_delete(ring);
+		(*env)->DeleteGlobalRef(env, cls);
+		if (in)
+			sox_close(in);
+		sox_quit();
+		return -1;
+	}
 
 	chain = sox_create_effects_chain(&in->encoding, &out->encoding);
+	/* Keep tempo & vol in the chain even at 1, so that setTempo and setVolume
+	 * can change them while playing */
+	chain->adjustable = sox_true;
+	/* vol & tempo pass floats between them, not clipped or rounded */
+	chain->use_float = sox_true;
 	/* The first effect in the effect chain must be something that can source
 	 * samples; in this case, we use the built-in handler that inputs
 	 * data from an audio file */
@@ -158,6 +178,11 @@ JNIEXPORT jint JNICALL Java_com_sox_player_SoxPlayerActivity_play(JNIEnv* env,
 	/* Add the effect to the end of the effects processing chain: */
 	sox_add_effect(chain, e, &in->signal, &in->signal);
 
+	/* Create the `tempo' effect, initially with no change: */
+	e = sox_create_effect(sox_find_effect("tempo"));
+	args[0] = "1", sox_effect_options(e, 1, args);
+	sox_add_effect(chain, e, &in->signal, &in->signal);
+
 	/* Create the `flanger' effect, and initialise it with default parameters: */
 	e = sox_create_effect(sox_find_effect("flanger"));
 	sox_effect_options(e, 0, NULL);
@@ -171,21 +196,49 @@ JNIEXPORT jint JNICALL Java_com_sox_player_SoxPlayerActivity_play(JNIEnv* env,
 	args[0] = (char *) out, sox_effect_options(e, 1, args);
 	sox_add_effect(chain, e, &in->signal, &in->signal);
 
-	sox_flow_effects(chain, NULL, NULL);
+	/* Decode, effects and the ring writer each get a thread of their own */
+	pthread_mutex_lock(&playing_lock);
+	playing = chain;
+	pthread_mutex_unlock(&playing_lock);
+	sox_pipeline_effects(chain, NULL, NULL);
+	pthread_mutex_lock(&playing_lock);
+	playing = NULL;
+	pthread_mutex_unlock(&playing_lock);
 
-	pthread_join(thread, &status);
-	alldone = 1;
 	sox_delete_effects_chain(chain);
-	sox_close(out);
+	sox_close(out); /* Marks end of stream; the player drains what is left */
+	pthread_join(thread, &status);
+	sox_ring_delete(ring);
+	(*env)->DeleteGlobalRef(env, cls);
 
 	sox_close(in);
 
-#if !defined FIXED_BUFFER
-	free(buffer);
-#endif
 	sox_quit();
 
 	return 0;
 
 }
 
+/* Changes a parameter of the playing chain; called from the UI thread.  The
+ * change is heard within tens of ms, with no gap in the audio. */
+static jint set_param(char const * effect, char const * name, double value) {
+
+	int result = SOX_EOF;
+
+	pthread_mutex_lock(&playing_lock);
+	if (playing)
+		result = sox_effects_set_param(playing, effect, name, value);
+	pthread_mutex_unlock(&playing_lock);
+	return result;
+
+}
+
+JNIEXPORT jint JNICALL Java_com_sox_player_SoxPlayerActivity_setTempo(
+		JNIEnv* env, jobject obj, jdouble factor) {
+	return set_param("tempo", "factor", factor);
+}
+
+JNIEXPORT jint JNICALL Java_com_sox_player_SoxPlayerActivity_setVolume(
+		JNIEnv* env, jobject obj, jdouble gain) {
+	return set_param("vol", "gain", gain);
+}
@@ -13,11 +13,13 @@ import android.widget.Button;
 import android.widget.SeekBar;
 import android.widget.Toast;
 
+import java.nio.ByteBuffer;
+
 public class SoxPlayerActivity extends Activity {
 
 	static AudioTrack track;
 	static int start = 0;
-	static byte[] buffer2;
+	static ByteBuffer ring;
 	static int buf_s;
 	int n = 0;
 	public static int res = 0;
@@ -35,11 +37,9 @@ public class SoxPlayerActivity extends Activity {
 				AudioFormat.CHANNEL_CONFIGURATION_STEREO,
 				AudioFormat.ENCODING_PCM_16BIT, bufSize, AudioTrack.MODE_STREAM);
 
-		buffer2 = new byte[17000];
-		
 		mAudioThread = new Thread(new Runnable() {
 			public void run() {
-				int res2 = play(buffer2);
+				int res2 = play();
 				System.out.println(res2);
 			}
 		});
@@ -48,15 +48,28 @@ public class SoxPlayerActivity extends Activity {
 		
 	}
 
-	public static void writeBytes(int length) {
+	/* Called once by native code with the ring the PCM is queued in */
+	public static void setBuffer(ByteBuffer b) {
+		ring = b;
+	}
 
-		int i = 0;
-		byte[] buf = buffer2;
-		int byt = track.write(buf, 0, length);
-		if (byt >= 16000 && res != 1) {
+	/* Called from the native player thread with PCM that lies in one piece
+	 * in the ring; the bytes stay put until this returns.  Returns the number
+	 * of bytes written, which is less than length only if AudioTrack stopped
+	 * taking them, or else AudioTrack's (negative) error code. */
+	public static int writeBlock(int offset, int length) {
+
+		int done = 0, byt;
+		if (track.getPlayState() != AudioTrack.PLAYSTATE_PLAYING)
 			track.play();
-			res++;
+		ring.limit(offset + length).position(offset);
+		while (done < length) {
+			byt = track.write(ring, length - done, AudioTrack.WRITE_BLOCKING);
+			if (byt <= 0)
+				return done > 0 ? done : byt;
+			done += byt;
 		}
+		return done;
 	}
 
 	public static byte[] charToBytesASCII(char[] buffer) {
@@ -69,7 +82,11 @@ public class SoxPlayerActivity extends Activity {
 		return b;
 	}
 
-	native int play(byte[] buffer22);
+	native int play();
+
+	/* Change playback while playing; return 0 on success */
+	native int setTempo(double factor);
+	native int setVolume(double gain);
 
 	static {
 		System.loadLibrary("c");